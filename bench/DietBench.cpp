@@ -0,0 +1,624 @@
+// diet_bench: times the database and log hot paths over synthetic data and
+// prints the results as JSON.
+//
+//   diet_bench [--basic N] [--composite N] [--log N] [--days N] [--seed N]
+//              [--repeat N] [--queries N] [--threads N] [--dir path]
+//
+// Every case reports ns per operation, operations (and items) per second and
+// heap allocations per operation, counted by replacing operator new. The
+// checks alongside verify what the cases exercise; any failure makes the
+// exit status 1.
+
+#include "SyntheticData.h"
+#include "Database/FoodDatabase.h"
+#include "Database/DailyLog.h"
+#include "Database/Snapshot.h"
+#include "Food/CompositeFood.h"
+#include "Food/FoodVisit.h"
+#include "Food/NutrientKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+
+void* countedAllocation(std::size_t size, std::size_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* memory = alignment > alignof(std::max_align_t)
+        ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : std::malloc(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* countedAllocation(std::size_t size, std::size_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocation(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+// Every replaceable form goes through countedAllocation, so no allocation
+// escapes the counter and every delete matches its new
+void* operator new(std::size_t size) {
+    return countedAllocation(size, 0);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocation(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAllocation(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAllocation(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t& tag) noexcept {
+    return countedAllocation(size, 0, tag);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return countedAllocation(size, 0, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return countedAllocation(size, static_cast<std::size_t>(alignment), tag);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return countedAllocation(size, static_cast<std::size_t>(alignment), tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+namespace diet {
+namespace {
+
+struct Options {
+    SyntheticData::Sizes sizes;
+    size_t repeat = 3;
+    size_t queries = 100000;
+    unsigned threads = 0; // 0 leaves the database default
+    std::string dir;
+};
+
+struct Result {
+    std::string name;
+    uint64_t operations;
+    uint64_t itemsPerOperation;
+    double seconds;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+struct Check {
+    std::string name;
+    bool passed;
+};
+
+// A save allocates the same whatever the database size: for each of its
+// two files, the path, the temporary path and the write buffer
+constexpr uint64_t SAVE_ALLOCATION_LIMIT = 6;
+
+// Runs body once, which performs operations operations, and records the
+// time and allocations it took
+template <typename Body>
+Result measure(const std::string& name, uint64_t operations, uint64_t itemsPerOperation, Body&& body) {
+    uint64_t allocationsBefore = allocationCount.load();
+    uint64_t bytesBefore = allocatedBytes.load();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    // Read the counters before copying name, which may allocate
+    uint64_t allocations = allocationCount.load() - allocationsBefore;
+    uint64_t bytes = allocatedBytes.load() - bytesBefore;
+    return Result{name, operations, itemsPerOperation, std::chrono::duration<double>(elapsed).count(),
+                  allocations, bytes};
+}
+
+std::string jsonNumber(double value) {
+    std::ostringstream out;
+    out.precision(6);
+    out << value;
+    return out.str();
+}
+
+void printJson(const Options& options, const std::vector<Result>& results, const std::vector<Check>& checks) {
+    const auto& sizes = options.sizes;
+    std::cout << "{\"config\":{\"basic\":" << sizes.basicFoods
+              << ",\"composite\":" << sizes.compositeFoods
+              << ",\"log\":" << sizes.logEntries
+              << ",\"days\":" << sizes.logDays
+              << ",\"seed\":" << sizes.seed
+              << ",\"repeat\":" << options.repeat
+              << ",\"queries\":" << options.queries
+              << ",\"threads\":" << options.threads
+              << ",\"kernel\":\"" << NutrientKernels::activeKernel() << "\"},\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double ops = static_cast<double>(r.operations);
+        double perSecond = r.seconds > 0 ? ops / r.seconds : 0.0;
+        std::cout << (i > 0 ? "," : "") << "\n{\"name\":\"" << r.name << "\""
+                  << ",\"operations\":" << r.operations
+                  << ",\"seconds\":" << jsonNumber(r.seconds)
+                  << ",\"ns_per_op\":" << jsonNumber(r.seconds * 1e9 / ops)
+                  << ",\"ops_per_sec\":" << jsonNumber(perSecond)
+                  << ",\"items_per_sec\":" << jsonNumber(perSecond * static_cast<double>(r.itemsPerOperation))
+                  << ",\"allocations_per_op\":" << jsonNumber(static_cast<double>(r.allocations) / ops)
+                  << ",\"bytes_per_op\":" << jsonNumber(static_cast<double>(r.bytes) / ops) << "}";
+    }
+    std::cout << "\n],\"checks\":[";
+    for (size_t i = 0; i < checks.size(); ++i) {
+        std::cout << (i > 0 ? "," : "") << "\n{\"name\":\"" << checks[i].name << "\",\"passed\":"
+                  << (checks[i].passed ? "true" : "false") << "}";
+    }
+    std::cout << "\n]}\n";
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--basic N] [--composite N] [--log N] [--days N] [--seed N]\n"
+              << "       [--repeat N] [--queries N] [--threads N] [--dir path]\n"
+              << "  Generates synthetic data in --dir (default: a temporary directory,\n"
+              << "  removed afterwards) and prints timings as JSON.\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--dir") {
+                options.dir = value;
+            } else if (arg == "--basic") {
+                options.sizes.basicFoods = std::stoull(value);
+            } else if (arg == "--composite") {
+                options.sizes.compositeFoods = std::stoull(value);
+            } else if (arg == "--log") {
+                options.sizes.logEntries = std::stoull(value);
+            } else if (arg == "--days") {
+                options.sizes.logDays = std::stoull(value);
+            } else if (arg == "--seed") {
+                options.sizes.seed = std::stoull(value);
+            } else if (arg == "--repeat") {
+                options.repeat = std::stoull(value);
+            } else if (arg == "--queries") {
+                options.queries = std::stoull(value);
+            } else if (arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return options.repeat > 0 && options.queries > 0 && options.sizes.basicFoods > 0;
+}
+
+// Cheap deterministic index stream for picking query targets
+struct QueryStream {
+    uint64_t state;
+    size_t below(size_t bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<size_t>((state >> 33) % bound);
+    }
+};
+
+bool sameFood(const Food& a, const Food& b) {
+    if (a.getKind() != b.getKind() || a.getId() != b.getId() || a.getName() != b.getName() ||
+        a.getKeywords() != b.getKeywords()) {
+        return false;
+    }
+    NutrientVector left = a.getNutrients();
+    NutrientVector right = b.getNutrients();
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        if (left[n] != right[n]) return false;
+    }
+    if (auto basic = foodAs<BasicFood>(&a)) {
+        auto other = foodAs<BasicFood>(&b);
+        return basic->getVitamins() == other->getVitamins() && basic->getMinerals() == other->getMinerals();
+    }
+    const auto& components = foodAs<CompositeFood>(&a)->getComponents();
+    const auto& otherComponents = foodAs<CompositeFood>(&b)->getComponents();
+    if (components.size() != otherComponents.size()) return false;
+    for (size_t c = 0; c < components.size(); ++c) {
+        if (components[c].first->getId() != otherComponents[c].first->getId() ||
+            components[c].second != otherComponents[c].second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameFoods(const FoodDatabase& a, const FoodDatabase& b) {
+    auto sameList = [](const std::vector<std::shared_ptr<Food>>& left,
+                       const std::vector<std::shared_ptr<Food>>& right) {
+        if (left.size() != right.size()) return false;
+        for (size_t i = 0; i < left.size(); ++i) {
+            if (!sameFood(*left[i], *right[i])) return false;
+        }
+        return true;
+    };
+    return sameList(a.getBasicFoods(), b.getBasicFoods()) && sameList(a.getCompositeFoods(), b.getCompositeFoods());
+}
+
+// Whether every term finds the same foods, in the same order, in both
+bool sameSearches(const FoodDatabase& a, const FoodDatabase& b, const std::vector<std::string>& terms) {
+    for (const auto& term : terms) {
+        auto left = a.findFoodsByKeyword(term);
+        auto right = b.findFoodsByKeyword(term);
+        if (left.size() != right.size()) return false;
+        for (size_t i = 0; i < left.size(); ++i) {
+            if (left[i]->getId() != right[i]->getId()) return false;
+        }
+    }
+    return true;
+}
+
+// Feeds db damaged copies of a valid snapshot. Each must be rejected with
+// db left as it was.
+void checkCorruptSnapshots(const std::string& snapshotFile, const std::string& dir, FoodDatabase& db,
+                           std::vector<Check>& checks) {
+    std::ifstream in(snapshotFile, std::ios::binary);
+    const std::string valid((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string corruptFile = dir + "/corrupt.snap";
+    size_t basicCount = db.getBasicFoods().size();
+    size_t compositeCount = db.getCompositeFoods().size();
+
+    auto rejects = [&](const std::string& name, const std::string& bytes) {
+        std::ofstream(corruptFile, std::ios::binary | std::ios::trunc) << bytes;
+        bool threw = false;
+        try {
+            db.loadSnapshot(corruptFile);
+        } catch (const FoodDatabase::DatabaseException&) {
+            threw = true;
+        }
+        checks.push_back({name, threw && db.getBasicFoods().size() == basicCount &&
+                                db.getCompositeFoods().size() == compositeCount});
+    };
+
+    rejects("snapshot rejects truncation", valid.substr(0, valid.size() / 2));
+    std::string badMagic = valid;
+    badMagic[0] = 'X';
+    rejects("snapshot rejects bad magic", badMagic);
+
+    // Posting lists must stay sorted for the intersections in find()
+    snapshot::Header header;
+    std::memcpy(&header, valid.data(), sizeof(header));
+    std::string unsorted = valid;
+    auto postingStarts =
+        reinterpret_cast<const uint32_t*>(valid.data() + header.sectionOffsets[snapshot::SEARCH_POSTING_STARTS]);
+    auto postings = reinterpret_cast<uint32_t*>(&unsorted[header.sectionOffsets[snapshot::SEARCH_POSTINGS]]);
+    for (uint32_t g = 0; g < header.gramCount; ++g) {
+        if (postingStarts[g + 1] - postingStarts[g] >= 2) {
+            std::swap(postings[postingStarts[g]], postings[postingStarts[g] + 1]);
+            rejects("snapshot rejects unsorted postings", unsorted);
+            break;
+        }
+    }
+
+    // Point the first nested composite found back at the one containing it
+    std::string cyclic = valid;
+    auto starts = reinterpret_cast<const uint32_t*>(valid.data() + header.sectionOffsets[snapshot::COMPONENT_STARTS]);
+    auto foods = reinterpret_cast<uint32_t*>(&cyclic[header.sectionOffsets[snapshot::COMPONENT_FOODS]]);
+    for (uint32_t i = 0; i < header.compositeCount; ++i) {
+        for (uint32_t c = starts[i]; c < starts[i + 1]; ++c) {
+            if (foods[c] < header.basicCount) continue;
+            uint32_t nested = foods[c] - header.basicCount;
+            if (nested != i && starts[nested] < starts[nested + 1]) {
+                foods[starts[nested]] = header.basicCount + i;
+                rejects("snapshot rejects cycles", cyclic);
+                return;
+            }
+        }
+    }
+}
+
+std::vector<Result> runBenchmarks(const Options& options, const std::string& dir, std::vector<Check>& checks) {
+    const auto& sizes = options.sizes;
+    std::string basicFile = dir + "/basic_foods.txt";
+    std::string compositeFile = dir + "/composite_foods.txt";
+    std::string logFile = dir + "/daily_log.txt";
+
+    SyntheticData data(sizes);
+    data.writeBasicFoods(basicFile);
+    data.writeCompositeFoods(compositeFile);
+    data.writeDailyLog(logFile);
+
+    std::vector<Result> results;
+    FoodDatabase db(basicFile, compositeFile);
+    if (options.threads > 0) {
+        db.setLoadThreads(options.threads);
+    }
+    uint64_t foodCount = sizes.basicFoods + sizes.compositeFoods;
+    results.push_back(measure("load", options.repeat, foodCount, [&] {
+        for (size_t r = 0; r < options.repeat; ++r) {
+            db.loadDatabase();
+        }
+    }));
+
+    // Snapshots are read back into a second database, so db stays as
+    // loaded from the text files
+    std::string snapshotFile = dir + "/foods.snap";
+    results.push_back(measure("saveSnapshot", options.repeat, foodCount, [&] {
+        for (size_t r = 0; r < options.repeat; ++r) {
+            db.saveSnapshot(snapshotFile);
+        }
+    }));
+    FoodDatabase snapshotDb(basicFile, compositeFile);
+    results.push_back(measure("loadSnapshot", options.repeat, foodCount, [&] {
+        for (size_t r = 0; r < options.repeat; ++r) {
+            snapshotDb.loadSnapshot(snapshotFile);
+        }
+    }));
+    checkCorruptSnapshots(snapshotFile, dir, snapshotDb, checks);
+    checks.push_back({"snapshot round trip", sameFoods(db, snapshotDb)});
+
+    const std::vector<std::string> terms = {"apple", "ric", "meal", "smoked tuna", "ch", "xyz"};
+    checks.push_back({"snapshot search index round trip", sameSearches(db, snapshotDb, terms)});
+
+    std::vector<std::string> ids;
+    QueryStream stream{sizes.seed};
+    ids.reserve(1024);
+    for (size_t i = 0; i < 1024; ++i) {
+        ids.push_back(i % 4 == 3 && sizes.compositeFoods > 0
+                          ? "c_" + std::to_string(1 + stream.below(sizes.compositeFoods))
+                          : "b_" + std::to_string(1 + stream.below(sizes.basicFoods)));
+    }
+    size_t found = 0;
+    results.push_back(measure("findFoodById", options.queries, 1, [&] {
+        for (size_t q = 0; q < options.queries; ++q) {
+            found += db.findFoodById(ids[q % ids.size()]) != nullptr;
+        }
+    }));
+    checks.push_back({"findFoodById allocates nothing", results.back().allocations == 0});
+
+    // Lookup plus concrete-type dispatch, the way callers did it before the
+    // kind tag (a shared_ptr copy and dynamic_pointer_cast) and now (a raw
+    // handle and visitFood)
+    double rttiCalories = 0.0;
+    results.push_back(measure("findFoodById+dynamic_pointer_cast", options.queries, 1, [&] {
+        for (size_t q = 0; q < options.queries; ++q) {
+            auto food = db.findFoodById(ids[q % ids.size()]);
+            if (auto basic = std::dynamic_pointer_cast<BasicFood>(food)) {
+                rttiCalories += basic->getCalories();
+            } else if (auto composite = std::dynamic_pointer_cast<CompositeFood>(food)) {
+                rttiCalories += composite->getCalories();
+            }
+        }
+    }));
+    double taggedCalories = 0.0;
+    results.push_back(measure("findFoodHandle+visitFood", options.queries, 1, [&] {
+        for (size_t q = 0; q < options.queries; ++q) {
+            if (const Food* food = db.findFoodHandle(ids[q % ids.size()])) {
+                taggedCalories += visitFood(*food, [](const auto& concrete) { return concrete.getCalories(); });
+            }
+        }
+    }));
+    checks.push_back({"tagged dispatch matches RTTI", taggedCalories == rttiCalories});
+
+    size_t searches = std::max<size_t>(1, options.queries / 100);
+    size_t matches = 0;
+
+    // Searches reuse one results vector; a first pass over every term grows
+    // it and the index's scratch space to their working size
+    std::vector<std::shared_ptr<Food>> searchResults;
+    for (const auto& term : terms) {
+        db.findFoodsByKeyword(term, searchResults);
+    }
+    results.push_back(measure("findFoodsByKeyword", searches, 1, [&] {
+        for (size_t q = 0; q < searches; ++q) {
+            db.findFoodsByKeyword(terms[q % terms.size()], searchResults);
+            matches += searchResults.size();
+        }
+    }));
+    checks.push_back({"findFoodsByKeyword allocates nothing", results.back().allocations == 0});
+
+    // Ranges chosen to select roughly a tenth of the generated foods
+    size_t scans = std::max<size_t>(1, options.queries / 1000);
+    size_t filtered = 0;
+    results.push_back(measure("findBasicFoodsByNutrient", scans, sizes.basicFoods, [&] {
+        for (size_t q = 0; q < scans; ++q) {
+            double low = static_cast<double>(q % 10) * 90.0;
+            filtered += db.findBasicFoodsByNutrient(NutrientVector::CALORIES, low, low + 90.0).size();
+        }
+    }));
+
+    // Both nutrient kernels over the same batches of random rows; whichever
+    // accumulate() dispatches to is named in the config
+    const NutrientColumns& columns = db.getNutrientColumns();
+    const size_t batch = 4096;
+    std::vector<uint32_t> rows(batch);
+    std::vector<double> servings(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        rows[i] = static_cast<uint32_t>(stream.below(columns.size()));
+        servings[i] = static_cast<double>(1 + stream.below(30)) / 10;
+    }
+    size_t kernelRuns = std::max<size_t>(1, options.queries / 100);
+    NutrientVector dispatched, scalar;
+    results.push_back(measure("NutrientKernels::accumulate", kernelRuns, batch, [&] {
+        for (size_t q = 0; q < kernelRuns; ++q) {
+            NutrientKernels::accumulate(columns, rows.data(), servings.data(), batch, dispatched);
+        }
+    }));
+    results.push_back(measure("NutrientKernels::accumulateScalar", kernelRuns, batch, [&] {
+        for (size_t q = 0; q < kernelRuns; ++q) {
+            NutrientKernels::accumulateScalar(columns, rows.data(), servings.data(), batch, scalar);
+        }
+    }));
+
+    // The kernels add in different orders, so allow rounding differences
+    bool kernelsAgree = true;
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        double scale = std::max({std::fabs(dispatched[n]), std::fabs(scalar[n]), 1.0});
+        kernelsAgree = kernelsAgree && std::fabs(dispatched[n] - scalar[n]) <= 1e-9 * scale;
+    }
+    checks.push_back({"nutrient kernels agree", kernelsAgree});
+
+    const auto& composites = db.getCompositeFoods();
+    double calories = 0.0;
+    if (!composites.empty()) {
+        results.push_back(measure("CompositeFood::getCalories", options.queries, 1, [&] {
+            for (size_t q = 0; q < options.queries; ++q) {
+                calories += composites[q % composites.size()]->getCalories();
+            }
+        }));
+    }
+
+    // A save only writes changed files, so each round first changes both;
+    // only the saves themselves are timed
+    auto basicIds = db.generateBasicFoodIds(options.repeat);
+    auto compositeIds = db.generateCompositeFoodIds(options.repeat);
+    Result save{"saveDatabase", options.repeat, foodCount, 0.0, 0, 0};
+    for (size_t r = 0; r < options.repeat; ++r) {
+        db.addBasicFood(std::make_shared<BasicFood>(basicIds[r], "bench food", std::vector<std::string>{"bench"},
+                                                    1, 1, 1, 1, 0, 0, "none", "none"));
+        db.addCompositeFood(std::make_shared<CompositeFood>(compositeIds[r], "bench meal",
+                                                            std::vector<std::string>{"bench"}));
+        Result round = measure("saveDatabase", 1, foodCount, [&] { db.saveDatabase(); });
+        save.seconds += round.seconds;
+        save.allocations += round.allocations;
+        save.bytes += round.bytes;
+    }
+    results.push_back(save);
+    checks.push_back({"saveDatabase allocations stay fixed",
+                      save.allocations <= SAVE_ALLOCATION_LIMIT * options.repeat});
+
+    // With a database attached, loading also rebuilds the per-day totals
+    DailyLog log(logFile);
+    log.setFoodDatabase(&db);
+    std::ostringstream logDiagnostics;
+    results.push_back(measure("DailyLog::loadLog", options.repeat, sizes.logEntries, [&] {
+        for (size_t r = 0; r < options.repeat; ++r) {
+            log.loadLog(logDiagnostics);
+        }
+    }));
+
+    Date start = sizes.logStart;
+    size_t days = std::max<size_t>(1, sizes.logDays);
+    size_t entries = 0;
+    results.push_back(measure("getEntriesForDate", options.queries, 1, [&] {
+        for (size_t q = 0; q < options.queries; ++q) {
+            entries += log.getEntriesForDate(start.addDays(static_cast<int32_t>(stream.below(days)))).size();
+        }
+    }));
+
+    // Keep the results observable so the loops are not optimised away
+    if (found + matches + filtered + entries == 0 && calories == 0.0) {
+        std::cerr << "warning: every query came back empty\n";
+    }
+    return results;
+}
+
+} // namespace
+} // namespace diet
+
+int main(int argc, char* argv[]) {
+    diet::Options options;
+    if (!diet::parseOptions(argc, argv, options)) {
+        diet::printUsage(argv[0]);
+        return 2;
+    }
+
+    namespace fs = std::filesystem;
+    bool temporary = options.dir.empty();
+    fs::path dir = options.dir;
+    bool passed = true;
+    try {
+        if (temporary) {
+            dir = fs::temp_directory_path() /
+                  ("diet_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        }
+        fs::create_directories(dir);
+        std::vector<diet::Check> checks;
+        auto results = diet::runBenchmarks(options, dir.string(), checks);
+        diet::printJson(options, results, checks);
+        for (const auto& check : checks) {
+            passed = passed && check.passed;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "diet_bench: " << e.what() << "\n";
+        if (temporary) {
+            fs::remove_all(dir);
+        }
+        return 1;
+    }
+    if (temporary) {
+        fs::remove_all(dir);
+    }
+    return passed ? 0 : 1;
+}
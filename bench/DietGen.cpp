@@ -0,0 +1,97 @@
+// diet_gen: writes synthetic basic_foods.txt, composite_foods.txt and
+// daily_log.txt files for scale testing; see printUsage for the options.
+// The same options always produce the same files.
+
+#include "SyntheticData.h"
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace diet {
+namespace {
+
+struct Options {
+    SyntheticData::Sizes sizes;
+    std::string dir = ".";
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --out DIR          directory to write the three files to (default .)\n"
+              << "  --basic N          basic foods (default 100000)\n"
+              << "  --composite N      composite foods (default 10000)\n"
+              << "  --log N            daily log entries (default 100000)\n"
+              << "  --seed N           random seed (default 42)\n"
+              << "  --vocabulary N     distinct keywords (default 50)\n"
+              << "  --keywords N       at most N keywords per basic food (default 3)\n"
+              << "  --depth N          composite nesting levels (default 3)\n"
+              << "  --fanout N         at most N components per composite (default 5)\n"
+              << "  --start YYYY-MM-DD first log date (default 2024-01-01)\n"
+              << "  --days N           days the log spans (default 365)\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    auto& sizes = options.sizes;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--out") {
+                options.dir = value;
+            } else if (arg == "--start") {
+                if (!Date::parse(value, sizes.logStart)) {
+                    return false;
+                }
+            } else {
+                size_t number = std::stoull(value);
+                if (arg == "--basic") sizes.basicFoods = number;
+                else if (arg == "--composite") sizes.compositeFoods = number;
+                else if (arg == "--log") sizes.logEntries = number;
+                else if (arg == "--seed") sizes.seed = number;
+                else if (arg == "--vocabulary") sizes.vocabulary = number;
+                else if (arg == "--keywords") sizes.keywordsPerFood = number;
+                else if (arg == "--depth") sizes.compositeDepth = number;
+                else if (arg == "--fanout") sizes.fanOut = number;
+                else if (arg == "--days") sizes.logDays = number;
+                else return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    // Composites and log entries refer to basic foods, so there must be some
+    return sizes.basicFoods > 0 && sizes.vocabulary > 0 && sizes.compositeDepth > 0 &&
+           sizes.fanOut > 0 && sizes.logDays > 0;
+}
+
+} // namespace
+} // namespace diet
+
+int main(int argc, char* argv[]) {
+    diet::Options options;
+    if (!diet::parseOptions(argc, argv, options)) {
+        diet::printUsage(argv[0]);
+        return 2;
+    }
+
+    try {
+        std::filesystem::path dir(options.dir);
+        std::filesystem::create_directories(dir);
+        diet::SyntheticData data(options.sizes);
+        data.writeBasicFoods((dir / "basic_foods.txt").string());
+        data.writeCompositeFoods((dir / "composite_foods.txt").string());
+        data.writeDailyLog((dir / "daily_log.txt").string());
+    } catch (const std::exception& e) {
+        std::cerr << "diet_gen: " << e.what() << "\n";
+        return 1;
+    }
+
+    const auto& sizes = options.sizes;
+    std::cout << "Wrote " << sizes.basicFoods << " basic foods, " << sizes.compositeFoods
+              << " composites and " << sizes.logEntries << " log entries to " << options.dir << "\n";
+    return 0;
+}
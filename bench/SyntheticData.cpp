@@ -0,0 +1,150 @@
+#include "SyntheticData.h"
+#include "Database/AtomicFileWriter.h"
+#include "Database/Date.h"
+#include <algorithm>
+
+namespace diet {
+
+namespace {
+
+const char* const WORDS[] = {
+    "apple", "banana", "bread", "butter", "cheese", "chicken", "rice", "bean", "tomato", "onion",
+    "pepper", "carrot", "potato", "salmon", "tuna", "beef", "pork", "egg", "milk", "yogurt",
+    "oat", "wheat", "corn", "lentil", "pea", "spinach", "kale", "lettuce", "garlic", "ginger",
+    "honey", "sugar", "salt", "olive", "almond", "walnut", "peanut", "cashew", "coconut", "mango",
+    "berry", "grape", "lemon", "lime", "orange", "peach", "pear", "plum", "melon", "cherry",
+};
+const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+const char* const STYLES[] = {
+    "fresh", "roasted", "grilled", "baked", "raw", "steamed", "fried", "dried", "smoked", "spicy",
+};
+const size_t STYLE_COUNT = sizeof(STYLES) / sizeof(STYLES[0]);
+
+const char* const VITAMINS[] = {"A", "C", "A,C", "B6,C", "E,B3", "B1,B3", "D", "K", "B12", "none"};
+const char* const MINERALS[] = {"iron", "calcium", "potassium", "magnesium", "zinc", "sodium"};
+
+// Distinct streams per file, so each file only depends on the seed
+const uint64_t BASIC_STREAM = 0x62617369635f6631ULL;
+const uint64_t COMPOSITE_STREAM = 0x636f6d706f736974ULL;
+const uint64_t LOG_STREAM = 0x6461696c795f6c67ULL;
+
+} // namespace
+
+SyntheticData::SyntheticData(const Sizes& sizes) : sizes(sizes), state(sizes.seed) {}
+
+uint64_t SyntheticData::next() {
+    // splitmix64
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+size_t SyntheticData::below(size_t bound) {
+    return bound == 0 ? 0 : static_cast<size_t>(next() % bound);
+}
+
+std::string SyntheticData::keyword(size_t index) const {
+    // The base words first, then numbered variants of them
+    std::string text = WORDS[index % WORD_COUNT];
+    if (index >= WORD_COUNT) {
+        text += std::to_string(index / WORD_COUNT);
+    }
+    return text;
+}
+
+void SyntheticData::writeBasicFoods(const std::string& path) {
+    state = sizes.seed ^ BASIC_STREAM;
+    AtomicFileWriter out(path);
+    out << "# Format: id;name;keywords;calories;protein;carbs;fat;saturatedFat;fiber;vitamins;minerals\n";
+
+    size_t vocabulary = std::max<size_t>(1, sizes.vocabulary);
+    for (size_t i = 1; i <= sizes.basicFoods; ++i) {
+        std::string main = keyword(below(vocabulary));
+        out << "b_" << i << ';' << STYLES[below(STYLE_COUNT)] << ' ' << main << ' ' << i << ';';
+        if (sizes.keywordsPerFood > 0) {
+            out << main;
+            size_t extraKeywords = below(sizes.keywordsPerFood);
+            for (size_t k = 0; k < extraKeywords; ++k) {
+                out << ',' << keyword(below(vocabulary));
+            }
+        }
+
+        // Tenths keep the text short and exact
+        double fat = static_cast<double>(below(300)) / 10;
+        out << ';' << static_cast<double>(below(9000)) / 10
+            << ';' << static_cast<double>(below(400)) / 10
+            << ';' << static_cast<double>(below(900)) / 10
+            << ';' << fat
+            << ';' << static_cast<double>(below(static_cast<size_t>(fat * 10) + 1)) / 10
+            << ';' << static_cast<double>(below(150)) / 10
+            << ';' << VITAMINS[below(sizeof(VITAMINS) / sizeof(VITAMINS[0]))]
+            << ';' << MINERALS[below(sizeof(MINERALS) / sizeof(MINERALS[0]))] << '\n';
+    }
+    out.commit();
+}
+
+void SyntheticData::writeCompositeFoods(const std::string& path) {
+    state = sizes.seed ^ COMPOSITE_STREAM;
+    AtomicFileWriter out(path);
+    out << "# Format: id;name;keywords;components\n";
+    out << "# Components format: foodId:servings,foodId:servings,...\n";
+
+    // Level l holds composites [levelStart(l), levelStart(l + 1)), 0-based
+    size_t count = sizes.compositeFoods;
+    size_t depth = std::max<size_t>(1, std::min(sizes.compositeDepth, std::max<size_t>(1, count)));
+    auto levelStart = [&](size_t level) { return (level * count + depth - 1) / depth; };
+    size_t vocabulary = std::max<size_t>(1, sizes.vocabulary);
+    size_t fanOut = std::max<size_t>(1, sizes.fanOut);
+
+    size_t level = 0;
+    for (size_t i = 0; i < count; ++i) {
+        while (i >= levelStart(level + 1)) ++level;
+
+        std::string main = keyword(below(vocabulary));
+        out << "c_" << i + 1 << ';' << main << " meal " << i + 1 << ';' << "meal," << main << ';';
+
+        size_t components = 1 + below(fanOut);
+        for (size_t c = 0; c < components; ++c) {
+            if (c > 0) out << ',';
+            if (level > 0 && c == 0) {
+                // Ties this composite to the level below, fixing the depth
+                size_t first = levelStart(level - 1);
+                out << "c_" << first + 1 + below(levelStart(level) - first);
+            } else if (level > 0 && below(4) == 0) {
+                out << "c_" << 1 + below(levelStart(level));
+            } else {
+                out << "b_" << 1 + below(sizes.basicFoods);
+            }
+            out << ':' << static_cast<double>(1 + below(30)) / 10;
+        }
+        out << '\n';
+    }
+    out.commit();
+}
+
+void SyntheticData::writeDailyLog(const std::string& path) {
+    state = sizes.seed ^ LOG_STREAM;
+    AtomicFileWriter out(path);
+    out << "# Format: date;foodId;servings\n";
+
+    size_t days = std::max<size_t>(1, sizes.logDays);
+    for (size_t i = 0; i < sizes.logEntries; ++i) {
+        Date date = sizes.logStart.addDays(static_cast<int32_t>(i * days / sizes.logEntries));
+        out << date.toString() << ';';
+        if (sizes.compositeFoods > 0 && below(4) == 0) {
+            out << "c_" << 1 + below(sizes.compositeFoods);
+        } else {
+            out << "b_" << 1 + below(sizes.basicFoods);
+        }
+        out << ';' << static_cast<double>(1 + below(30)) / 10 << '\n';
+    }
+    out.commit();
+}
+
+const SyntheticData::Sizes& SyntheticData::getSizes() const {
+    return sizes;
+}
+
+} // namespace diet
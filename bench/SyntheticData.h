@@ -0,0 +1,66 @@
+#ifndef SYNTHETIC_DATA_H
+#define SYNTHETIC_DATA_H
+
+#include "Database/Date.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace diet {
+
+// Seeded generator for data files in the same formats diet_manager reads.
+// The same sizes and seed always produce byte-identical files on every
+// platform: the random stream is a fixed splitmix64 sequence rather than a
+// standard library distribution.
+class SyntheticData {
+public:
+    struct Sizes {
+        size_t basicFoods = 100000;
+        size_t compositeFoods = 10000;
+        size_t logEntries = 100000;
+        uint64_t seed = 42;
+
+        // Distinct keywords, and at most how many each food gets
+        size_t vocabulary = 50;
+        size_t keywordsPerFood = 3;
+
+        // Composites are split into compositeDepth levels. Level 0 ones
+        // contain only basic foods; each later level includes at least one
+        // composite of the level before. Every composite has 1..fanOut
+        // components.
+        size_t compositeDepth = 3;
+        size_t fanOut = 5;
+
+        // Log entries are spread evenly over logDays days from logStart
+        Date logStart = Date::fromCivil(2024, 1, 1);
+        size_t logDays = 365;
+    };
+
+private:
+    Sizes sizes;
+    uint64_t state;
+
+    uint64_t next();
+    size_t below(size_t bound);
+    std::string keyword(size_t index) const;
+
+public:
+    explicit SyntheticData(const Sizes& sizes);
+
+    // Each writer restarts the random stream from the seed, so the files do
+    // not depend on which others were written or in what order. All three
+    // throw std::runtime_error if the file cannot be written.
+    void writeBasicFoods(const std::string& path);
+
+    // Components only name foods earlier in the files, see Sizes
+    void writeCompositeFoods(const std::string& path);
+
+    // Entries in date order; about a quarter name composites
+    void writeDailyLog(const std::string& path);
+
+    const Sizes& getSizes() const;
+};
+
+} // namespace diet
+
+#endif // SYNTHETIC_DATA_H
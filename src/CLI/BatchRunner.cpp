@@ -0,0 +1,421 @@
+#include "BatchRunner.h"
+#include "../Food/FoodVisit.h"
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace diet {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+std::vector<std::string> split(const std::string& text, char delimiter) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find(delimiter, start);
+        parts.push_back(trim(text.substr(start, end == std::string::npos ? std::string::npos : end - start)));
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return parts;
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    for (auto& item : split(text, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Unlike std::stod, the whole field must be a finite number
+double parseNumber(const std::string& text, const std::string& what) {
+    double value = 0.0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || result.ec != std::errc() || result.ptr != text.data() + text.size() ||
+        !std::isfinite(value)) {
+        throw std::invalid_argument("Invalid " + what + ": " + text);
+    }
+    return value;
+}
+
+int parseIndex(const std::string& text) {
+    int value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        throw std::invalid_argument("Invalid index: " + text);
+    }
+    return value;
+}
+
+Date parseDate(const std::string& text) {
+    Date date;
+    if (!Date::parse(text, date)) {
+        throw std::invalid_argument("Invalid date: " + text + " (use YYYY-MM-DD)");
+    }
+    return date;
+}
+
+void requireArgs(const std::vector<std::string>& args, size_t min, size_t max, const std::string& usage) {
+    if (args.size() < min || args.size() > max) {
+        throw std::invalid_argument("Usage: " + usage);
+    }
+}
+
+std::string jsonString(std::string_view text) {
+    std::string out = "\"";
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    const char* hex = "0123456789abcdef";
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xf];
+                    out += hex[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+// JSON has no infinities or NaN; those can still come from the data files
+std::string jsonNumber(double value) {
+    if (!std::isfinite(value)) {
+        return "null";
+    }
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, result.ptr);
+}
+
+std::string jsonList(const std::vector<std::string>& items) {
+    std::string out = "[";
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) out += ",";
+        out += jsonString(items[i]);
+    }
+    return out + "]";
+}
+
+std::string jsonNutrients(const NutrientVector& n) {
+    return "{\"calories\":" + jsonNumber(n.calories()) +
+           ",\"protein\":" + jsonNumber(n.protein()) +
+           ",\"carbs\":" + jsonNumber(n.carbs()) +
+           ",\"fat\":" + jsonNumber(n.fat()) +
+           ",\"saturatedFat\":" + jsonNumber(n.saturatedFat()) +
+           ",\"fiber\":" + jsonNumber(n.fiber()) + "}";
+}
+
+// The type-specific part of a food's JSON, dispatched by visitFood
+struct JsonFoodFields {
+    std::string operator()(const BasicFood& basic) const {
+        return ",\"type\":\"basic\",\"keywords\":" + jsonList(basic.getKeywords()) +
+               ",\"nutrients\":" + jsonNutrients(basic.getNutrients()) +
+               ",\"vitamins\":" + jsonString(basic.getVitamins()) +
+               ",\"minerals\":" + jsonString(basic.getMinerals());
+    }
+
+    std::string operator()(const CompositeFood& comp) const {
+        std::string out = ",\"type\":\"composite\",\"keywords\":" + jsonList(comp.getKeywords()) +
+                          ",\"nutrients\":" + jsonNutrients(comp.getNutrients()) + ",\"components\":[";
+        const auto& components = comp.getComponents();
+        for (size_t i = 0; i < components.size(); ++i) {
+            if (i > 0) out += ",";
+            out += "{\"id\":" + jsonString(components[i].first->getId()) +
+                   ",\"servings\":" + jsonNumber(components[i].second) + "}";
+        }
+        return out + "]";
+    }
+};
+
+std::string jsonFood(const Food& food) {
+    return "{\"id\":" + jsonString(food.getId()) +
+           ",\"name\":" + jsonString(food.getName()) + visitFood(food, JsonFoodFields{}) + "}";
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(FoodDatabase& db, DailyLog& log) : db(db), log(log) {
+    registerHandlers();
+}
+
+void BatchRunner::registerHandlers() {
+    auto bind = [this](void (BatchRunner::*method)(const Args&, std::string&)) {
+        return [this, method](const Args& args, std::string& result) { (this->*method)(args, result); };
+    };
+    handlers["add-basic"] = bind(&BatchRunner::addBasic);
+    handlers["add-composite"] = bind(&BatchRunner::addComposite);
+    handlers["add-component"] = bind(&BatchRunner::addComponent);
+    handlers["remove-food"] = bind(&BatchRunner::removeFood);
+    handlers["used-by"] = bind(&BatchRunner::usedBy);
+    handlers["get"] = bind(&BatchRunner::getFood);
+    handlers["search"] = bind(&BatchRunner::search);
+    handlers["filter"] = bind(&BatchRunner::filter);
+    handlers["log"] = bind(&BatchRunner::logFood);
+    handlers["unlog"] = bind(&BatchRunner::unlog);
+    handlers["entries"] = bind(&BatchRunner::entries);
+    handlers["totals"] = bind(&BatchRunner::totals);
+    handlers["summary"] = bind(&BatchRunner::summary);
+    handlers["save"] = bind(&BatchRunner::save);
+    handlers["save-snapshot"] = bind(&BatchRunner::saveSnapshot);
+    handlers["load-snapshot"] = bind(&BatchRunner::loadSnapshot);
+}
+
+size_t BatchRunner::run(std::istream& in, std::ostream& out) {
+    std::string line;
+    size_t lineNumber = 0;
+    size_t failures = 0;
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::string command = trim(line);
+        if (command.empty() || command[0] == '#') continue;
+
+        Args args = split(command, ';');
+        std::string name = args.front();
+        args.erase(args.begin());
+
+        std::string head = "{\"line\":" + std::to_string(lineNumber) + ",\"command\":" + jsonString(name);
+        std::string result;
+        try {
+            auto handler = handlers.find(name);
+            if (handler == handlers.end()) {
+                throw std::invalid_argument("Unknown command: " + name);
+            }
+            handler->second(args, result);
+            out << head << ",\"status\":\"ok\"" << result << "}\n";
+        } catch (const std::exception& e) {
+            failures++;
+            out << head << ",\"status\":\"error\",\"error\":" << jsonString(e.what()) << "}\n";
+        }
+    }
+    out.flush();
+    return failures;
+}
+
+void BatchRunner::addBasic(const Args& args, std::string& result) {
+    requireArgs(args, 10, 10,
+                "add-basic;name;keywords;calories;protein;carbs;fat;saturatedFat;fiber;vitamins;minerals");
+    double values[NutrientVector::COUNT];
+    const char* names[] = {"calories", "protein", "carbs", "fat", "saturated fat", "fiber"};
+    for (size_t i = 0; i < NutrientVector::COUNT; ++i) {
+        values[i] = parseNumber(args[2 + i], names[i]);
+    }
+
+    std::string id = db.generateBasicFoodId();
+    db.addBasicFood(std::make_shared<BasicFood>(
+        id, args[0], splitList(args[1]),
+        values[0], values[1], values[2], values[3], values[4], values[5],
+        args[8], args[9]));
+    result += ",\"id\":" + jsonString(id);
+}
+
+void BatchRunner::addComposite(const Args& args, std::string& result) {
+    requireArgs(args, 3, 3, "add-composite;name;keywords;foodId:servings,...");
+
+    // Resolve every component before touching the database
+    std::vector<std::pair<std::shared_ptr<Food>, double>> components;
+    for (const auto& item : splitList(args[2])) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("Component must be foodId:servings: " + item);
+        }
+        std::string foodId = trim(item.substr(0, colon));
+        auto food = db.findFoodById(foodId);
+        if (!food) {
+            throw std::invalid_argument("Food ID not found: " + foodId);
+        }
+        components.emplace_back(food, parseNumber(trim(item.substr(colon + 1)), "servings"));
+    }
+
+    std::string id = db.generateCompositeFoodId();
+    auto comp = std::make_shared<CompositeFood>(id, args[0], splitList(args[1]));
+    for (const auto& component : components) {
+        comp->addComponent(component.first, component.second);
+    }
+    db.addCompositeFood(comp);
+    result += ",\"id\":" + jsonString(id);
+}
+
+void BatchRunner::addComponent(const Args& args, std::string&) {
+    requireArgs(args, 3, 3, "add-component;compositeId;foodId;servings");
+    db.addComponent(args[0], args[1], parseNumber(args[2], "servings"));
+
+    // Only days logging this composite or one containing it are affected
+    bool logged = log.refersTo(args[0]);
+    for (const auto& food : db.findDependentFoods(args[0])) {
+        logged = logged || log.refersTo(food->getId());
+    }
+    if (logged) {
+        log.refreshTotals();
+    }
+}
+
+void BatchRunner::removeFood(const Args& args, std::string&) {
+    requireArgs(args, 1, 1, "remove-food;id");
+    if (!db.removeFood(args[0])) {
+        throw std::invalid_argument("Food not found with ID: " + args[0]);
+    }
+    // Entries naming the food now count as unknown; a food the log never
+    // mentions leaves every total as it was
+    if (log.refersTo(args[0])) {
+        log.refreshTotals();
+    }
+}
+
+void BatchRunner::usedBy(const Args& args, std::string& result) {
+    requireArgs(args, 1, 1, "used-by;id");
+    if (!db.findFoodById(args[0])) {
+        throw std::invalid_argument("Food not found with ID: " + args[0]);
+    }
+    std::vector<std::string> ids;
+    for (const auto& food : db.findDependentFoods(args[0])) {
+        ids.emplace_back(food->getId());
+    }
+    result += ",\"results\":" + jsonList(ids);
+}
+
+void BatchRunner::getFood(const Args& args, std::string& result) {
+    requireArgs(args, 1, 1, "get;id");
+    auto food = db.findFoodById(args[0]);
+    if (!food) {
+        throw std::invalid_argument("Food not found with ID: " + args[0]);
+    }
+    result += ",\"food\":" + jsonFood(*food);
+}
+
+void BatchRunner::search(const Args& args, std::string& result) {
+    requireArgs(args, 1, 1, "search;term");
+    if (args[0].empty()) {
+        throw std::invalid_argument("Search term cannot be empty");
+    }
+    std::vector<std::string> ids;
+    for (const auto& food : db.findFoodsByKeyword(args[0])) {
+        ids.emplace_back(food->getId());
+    }
+    result += ",\"results\":" + jsonList(ids);
+}
+
+void BatchRunner::filter(const Args& args, std::string& result) {
+    requireArgs(args, 3, 3, "filter;calories|protein|carbs|fat|saturatedFat|fiber;min;max");
+    // Same names as the nutrient fields of the JSON output
+    const char* names[] = {"calories", "protein", "carbs", "fat", "saturatedFat", "fiber"};
+    size_t nutrient = 0;
+    while (nutrient < NutrientVector::COUNT && args[0] != names[nutrient]) ++nutrient;
+    if (nutrient == NutrientVector::COUNT) {
+        throw std::invalid_argument("Unknown nutrient: " + args[0]);
+    }
+
+    std::vector<std::string> ids;
+    for (const auto& food : db.findBasicFoodsByNutrient(static_cast<NutrientVector::Index>(nutrient),
+                                                        parseNumber(args[1], "minimum"),
+                                                        parseNumber(args[2], "maximum"))) {
+        ids.emplace_back(food->getId());
+    }
+    result += ",\"results\":" + jsonList(ids);
+}
+
+void BatchRunner::logFood(const Args& args, std::string& result) {
+    requireArgs(args, 3, 3, "log;YYYY-MM-DD;foodId;servings");
+    Date date = parseDate(args[0]);
+    if (!db.findFoodById(args[1])) {
+        throw std::invalid_argument("Food not found with ID: " + args[1]);
+    }
+    log.addEntry(LogEntry(date, args[1], parseNumber(args[2], "servings")));
+    result += ",\"index\":" + std::to_string(log.getEntryCount() - 1);
+}
+
+void BatchRunner::unlog(const Args& args, std::string&) {
+    requireArgs(args, 1, 1, "unlog;index");
+    if (!log.removeEntry(parseIndex(args[0]))) {
+        throw std::invalid_argument("No log entry at index " + args[0]);
+    }
+}
+
+void BatchRunner::entries(const Args& args, std::string& result) {
+    requireArgs(args, 1, 2, "entries;from[;to]");
+    Date from = parseDate(args[0]);
+    Date to = args.size() > 1 ? parseDate(args[1]) : from;
+
+    auto range = log.getEntriesBetween(from, to);
+    result += ",\"entries\":[";
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        const auto& entry = *it;
+        if (it != range.begin()) result += ",";
+        result += "{\"index\":" + std::to_string(it.index()) +
+                  ",\"date\":" + jsonString(entry.date.toString()) +
+                  ",\"foodId\":" + jsonString(trim(entry.foodId)) +
+                  ",\"servings\":" + jsonNumber(entry.servings) + "}";
+    }
+    result += "]";
+}
+
+void BatchRunner::totals(const Args& args, std::string& result) {
+    requireArgs(args, 1, 2, "totals;from[;to]");
+    Date from = parseDate(args[0]);
+    Date to = args.size() > 1 ? parseDate(args[1]) : from;
+    result += ",\"totals\":" + jsonNutrients(log.getNutrientTotalsBetween(from, to));
+}
+
+void BatchRunner::summary(const Args& args, std::string& result) {
+    requireArgs(args, 3, 3, "summary;from;to;day|week|month");
+    SummaryPeriod period;
+    if (args[2] == "day") {
+        period = SummaryPeriod::DAY;
+    } else if (args[2] == "week") {
+        period = SummaryPeriod::WEEK;
+    } else if (args[2] == "month") {
+        period = SummaryPeriod::MONTH;
+    } else {
+        throw std::invalid_argument("Period must be day, week or month: " + args[2]);
+    }
+
+    result += ",\"buckets\":[";
+    bool first = true;
+    for (const auto& bucket : log.summarize(parseDate(args[0]), parseDate(args[1]), period)) {
+        if (!first) result += ",";
+        first = false;
+        result += "{\"start\":" + jsonString(bucket.start.toString()) +
+                  ",\"end\":" + jsonString(bucket.end.toString()) +
+                  ",\"totals\":" + jsonNutrients(bucket.totals) + "}";
+    }
+    result += "]";
+}
+
+void BatchRunner::save(const Args& args, std::string&) {
+    requireArgs(args, 0, 0, "save");
+    db.saveDatabase();
+    log.saveLog();
+}
+
+void BatchRunner::saveSnapshot(const Args& args, std::string&) {
+    requireArgs(args, 1, 1, "save-snapshot;path");
+    db.saveSnapshot(args[0]);
+}
+
+void BatchRunner::loadSnapshot(const Args& args, std::string& result) {
+    requireArgs(args, 1, 1, "load-snapshot;path");
+    if (!db.loadSnapshot(args[0])) {
+        throw std::invalid_argument("Snapshot not found: " + args[0]);
+    }
+    // Every food was replaced, so the log's totals have to be recomputed
+    log.refreshTotals();
+    result += ",\"basic\":" + std::to_string(db.getBasicFoods().size()) +
+              ",\"composite\":" + std::to_string(db.getCompositeFoods().size());
+}
+
+} // namespace diet
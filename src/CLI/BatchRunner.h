@@ -0,0 +1,79 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "../Database/FoodDatabase.h"
+#include "../Database/DailyLog.h"
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include <unordered_map>
+
+namespace diet {
+
+// Non-interactive command processor used by `diet_manager --batch`.
+//
+// Reads one command per line, fields separated by ';' as in the data files.
+// Blank lines and lines starting with '#' are ignored. Writes one JSON object
+// per command: {"line":N,"command":"...","status":"ok",...} or
+// {"line":N,"command":"...","status":"error","error":"..."}.
+//
+// Commands:
+//   add-basic;name;keywords;calories;protein;carbs;fat;saturatedFat;fiber;vitamins;minerals
+//   add-composite;name;keywords;foodId:servings,foodId:servings,...
+//   add-component;compositeId;foodId;servings
+//   remove-food;id
+//   used-by;id
+//   get;id
+//   search;term
+//   filter;calories|protein|carbs|fat|saturatedFat|fiber;min;max
+//   log;YYYY-MM-DD;foodId;servings
+//   unlog;index
+//   entries;from[;to]
+//   totals;from[;to]
+//   summary;from;to;day|week|month
+//   save
+//   save-snapshot;path
+//   load-snapshot;path
+class BatchRunner {
+private:
+    using Args = std::vector<std::string>;
+    using Handler = std::function<void(const Args& args, std::string& result)>;
+
+    FoodDatabase& db;
+    DailyLog& log;
+    std::unordered_map<std::string, Handler> handlers;
+
+    void registerHandlers();
+
+    // Command implementations; each appends ,"key":value pairs to result
+    // and throws on failure
+    void addBasic(const Args& args, std::string& result);
+    void addComposite(const Args& args, std::string& result);
+    void addComponent(const Args& args, std::string& result);
+    void removeFood(const Args& args, std::string& result);
+    void usedBy(const Args& args, std::string& result);
+    void getFood(const Args& args, std::string& result);
+    void search(const Args& args, std::string& result);
+    void filter(const Args& args, std::string& result);
+    void logFood(const Args& args, std::string& result);
+    void unlog(const Args& args, std::string& result);
+    void entries(const Args& args, std::string& result);
+    void totals(const Args& args, std::string& result);
+    void summary(const Args& args, std::string& result);
+    void save(const Args& args, std::string& result);
+    void saveSnapshot(const Args& args, std::string& result);
+    void loadSnapshot(const Args& args, std::string& result);
+
+public:
+    BatchRunner(FoodDatabase& db, DailyLog& log);
+
+    // Runs every command from in, reporting to out. Returns the number of
+    // commands that failed.
+    size_t run(std::istream& in, std::ostream& out);
+};
+
+} // namespace diet
+
+#endif // BATCH_RUNNER_H
@@ -1,12 +1,14 @@
 #include "CLIManager.h"
+#include "BatchRunner.h"
 #include "../Food/BasicFood.h"
 #include "../Food/CompositeFood.h"
 #include <iostream>
 #include <sstream>
 #include <limits>
 #include <fstream>
-#include <regex>
 #include <iomanip>
+#include <future>
+#include <algorithm>
 
 namespace diet {
 
@@ -93,50 +95,27 @@ public:
 };
 
 // CLIManager implementation
-bool CLIManager::validateBasicFoodsFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "❌ File not found or cannot be accessed: " << filename << std::endl;
+bool CLIManager::reportBasicFoodsStatus() const {
+    if (!db.isBasicFileLoaded()) {
+        std::cerr << "❌ File not found or cannot be accessed: " << basicFoodsFile << std::endl;
         std::cerr << "Please ensure the file exists and has proper read permissions." << std::endl;
         return false;
     }
 
-    std::string line;
-    int lineNumber = 0;
-    bool hasError = false;
-
-    while (std::getline(file, line)) {
-        lineNumber++;
-        if (line.empty() || line[0] == '#') continue;
-
-        std::stringstream ss(line);
-        std::string fields[11];
-        for (int i = 0; i < 11; ++i) {
-            if (!std::getline(ss, fields[i], ';')) {
-                std::cerr << "❌ Line " << lineNumber << ": Missing field " << i+1 << "\n";
-                hasError = true;
-                break;
-            }
-        }
-
-        for (int i = 3; i <= 8; ++i) {
-            try {
-                std::stod(fields[i]);
-            } catch (...) {
-                std::cerr << "❌ Line " << lineNumber << ": Invalid number in field " << i+1
-                          << " → " << fields[i] << "\n";
-                hasError = true;
-            }
-        }
-    }
-
-    if (!hasError) {
-        std::cout << "✅ basic_foods.txt passed validation.\n";
-    } else {
+    // Line-level problems were already printed as the loader met them. As
+    // before the passes were combined, only malformed fields stop startup;
+    // rows with an unusable ID are just skipped.
+    const auto& diagnostics = db.getBasicDiagnostics();
+    if (std::any_of(diagnostics.begin(), diagnostics.end(),
+                    [](const FoodDatabase::LoadDiagnostic& d) { return d.formatError; })) {
         std::cerr << "⚠️ Validation errors found. Please fix them before continuing.\n";
+        return false;
     }
 
-    return !hasError;
+    // Status goes to stderr with the other load messages, keeping stdout
+    // clean for batch output
+    std::cerr << "✅ basic_foods.txt passed validation.\n";
+    return true;
 }
 
 CLIManager::CLIManager(const std::string& basicFoodsPath, 
@@ -150,44 +129,41 @@ CLIManager::CLIManager(const std::string& basicFoodsPath,
       compositeFoodsFile(compositeFoodsPath),
       dailyLogFile(logPath) {
 
-    // Check if all required files exist or are accessible
-    bool filesOK = true;
-    
-    // Validate basic foods file before loading
-    if (!validateBasicFoodsFile(basicFoodsFile)) {
+    // One pass per file: loading validates, reports line-numbered
+    // diagnostics and builds the in-memory data at the same time.
+    // The log only needs the foods for its totals, so it is read while the
+    // database loads; its messages are held back to keep the usual order.
+    bool logFound = false;
+    try {
+        std::ostringstream logMessages;
+        auto logLoad = std::async(std::launch::async, [&] { return log.loadLog(logMessages); });
+        db.loadDatabase();
+        logFound = logLoad.get();
+        std::cerr << logMessages.str();
+        log.setFoodDatabase(&db);
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading data: " << e.what() << std::endl;
+        throw std::runtime_error("Failed to load database: " + std::string(e.what()));
+    }
+
+    if (!reportBasicFoodsStatus()) {
         std::cerr << "🚫 Invalid format or inaccessible basic foods file: " << basicFoodsFile << std::endl;
         std::cerr << "Fix the file and rerun the application." << std::endl;
-        filesOK = false;
+        throw std::runtime_error("Critical files are missing or have invalid format");
     }
-    
-    // Check if composite foods file exists and is accessible
-    std::ifstream compFile(compositeFoodsFile);
-    if (!compFile) {
+
+    if (!db.isCompositeFileLoaded()) {
         std::cerr << "⚠️ Composite foods file not found or inaccessible: " << compositeFoodsFile << std::endl;
         std::cerr << "A new file will be created when saving data." << std::endl;
         // Not fatal, will create on save
     }
-    
-    // Check if log file exists and is accessible
-    std::ifstream logFile(dailyLogFile);
-    if (!logFile) {
+
+    if (!logFound) {
         std::cerr << "⚠️ Log file not found or inaccessible: " << dailyLogFile << std::endl;
         std::cerr << "A new file will be created when saving data." << std::endl;
         // Not fatal, will create on save
     }
     
-    if (!filesOK) {
-        throw std::runtime_error("Critical files are missing or have invalid format");
-    }
-    
-    try {
-        db.loadDatabase(); // Only called if validation passed
-        log.loadLog();
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading data: " << e.what() << std::endl;
-        throw std::runtime_error("Failed to load database: " + std::string(e.what()));
-    }
-    
     // Initialize menu commands
     initializeMenu();
 }
@@ -230,6 +206,20 @@ void CLIManager::start() {
     }
 }
 
+size_t CLIManager::runBatch(std::istream& in, std::ostream& out) {
+    BatchRunner runner(db, log);
+    size_t failures = runner.run(in, out);
+
+    try {
+        db.saveDatabase();
+        log.saveLog();
+    } catch (const std::exception& e) {
+        std::cerr << "Error saving data: " << e.what() << "\n";
+        failures++;
+    }
+    return failures;
+}
+
 void CLIManager::showMenu() const {
     std::cout << "\n=== YADA: Yet Another Diet Assistant ===\n";
     
@@ -343,15 +333,15 @@ void CLIManager::handleAddCompositeFood() {
 }
 
 void CLIManager::handleAddLogEntry() {
-    std::string date, id;
+    std::string dateText, id;
+    Date date;
     double servings;
 
     std::cout << "Enter date (YYYY-MM-DD): ";
-    std::getline(std::cin, date);
+    std::getline(std::cin, dateText);
     
-    // Validate date format
-    std::regex datePattern(R"(\d{4}-\d{2}-\d{2})");
-    if (!std::regex_match(date, datePattern)) {
+    // Validate date format and that the day exists
+    if (!Date::parse(dateText, date)) {
         std::cout << "Invalid date format. Use YYYY-MM-DD.\n";
         pause();
         return;
@@ -10,6 +10,8 @@
 #include <memory>
 #include <unordered_map>
 #include <limits>
+#include <istream>
+#include <ostream>
 
 namespace diet {
 
@@ -46,6 +48,7 @@ private:
     // Helper methods
     std::vector<std::string> getKeywordsInput() const;
     void pause() const;
+    bool reportBasicFoodsStatus() const;
     bool validateInput(const std::string& input, const std::function<bool(const std::string&)>& validator) const;
     double getNumericInput(const std::string& prompt, double min = 0.0, double max = std::numeric_limits<double>::max()) const;
     int getIntInput(const std::string& prompt, int min = 0, int max = std::numeric_limits<int>::max()) const;
@@ -59,6 +62,10 @@ public:
     // Main entry point
     void start();
 
+    // Non-interactive mode: runs BatchRunner commands from in, writes JSON
+    // results to out and saves on completion. Returns the failure count.
+    size_t runBatch(std::istream& in, std::ostream& out);
+
     // Command implementations
     void handleViewBasicFoods();
     void handleViewCompositeFoods();
@@ -69,9 +76,6 @@ public:
     void handleViewProfile();
     void handleSearchFoods();
     void handleExit();
-
-    // Validator for basic foods file format
-    bool validateBasicFoodsFile(const std::string& filename);
 };
 
 } // namespace diet
@@ -0,0 +1,95 @@
+#include "AtomicFileWriter.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define DIET_HAVE_FSYNC 1
+#endif
+
+namespace diet {
+
+AtomicFileWriter::WriteException::WriteException(const std::string& message)
+    : std::runtime_error(message) {}
+
+AtomicFileWriter::AtomicFileWriter(const std::string& path)
+    : path(path) {
+    // Sized up front so building the name costs one allocation
+    tempPath.reserve(path.size() + 4);
+    tempPath.append(path).append(".tmp");
+    out = std::fopen(tempPath.c_str(), "wb");
+    if (!out) {
+        throw WriteException("Failed to open file for writing: " + path);
+    }
+    buffer.reserve(BUFFER_SIZE);
+}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    discard();
+}
+
+void AtomicFileWriter::discard() {
+    if (out) {
+        std::fclose(out);
+        out = nullptr;
+        std::remove(tempPath.c_str());
+    }
+}
+
+void AtomicFileWriter::flushBuffer() {
+    if (!out) {
+        throw WriteException("File was already committed: " + path);
+    }
+    if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size()) {
+        discard();
+        throw WriteException("Failed to write file: " + path);
+    }
+    buffer.clear();
+}
+
+AtomicFileWriter& AtomicFileWriter::operator<<(std::string_view text) {
+    if (buffer.size() + text.size() > BUFFER_SIZE) {
+        flushBuffer();
+        // Blocks as big as the buffer skip it
+        if (text.size() >= BUFFER_SIZE) {
+            if (std::fwrite(text.data(), 1, text.size(), out) != text.size()) {
+                discard();
+                throw WriteException("Failed to write file: " + path);
+            }
+            return *this;
+        }
+    }
+    buffer.append(text.data(), text.size());
+    return *this;
+}
+
+AtomicFileWriter& AtomicFileWriter::operator<<(char c) {
+    if (buffer.size() + 1 > BUFFER_SIZE) {
+        flushBuffer();
+    }
+    buffer.push_back(c);
+    return *this;
+}
+
+AtomicFileWriter& AtomicFileWriter::operator<<(double value) {
+    // %g at precision 6, which is what an ostream prints by default
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+    return *this << std::string_view(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+void AtomicFileWriter::commit() {
+    flushBuffer();
+
+    bool written = std::fflush(out) == 0;
+#ifdef DIET_HAVE_FSYNC
+    written = written && fsync(fileno(out)) == 0;
+#endif
+    written = std::fclose(out) == 0 && written;
+    out = nullptr;
+
+    if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw WriteException("Failed to write file: " + path);
+    }
+}
+
+} // namespace diet
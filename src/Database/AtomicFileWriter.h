@@ -0,0 +1,68 @@
+#ifndef ATOMIC_FILE_WRITER_H
+#define ATOMIC_FILE_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <cstdio>
+#include <charconv>
+#include <stdexcept>
+#include <type_traits>
+
+namespace diet {
+
+// Buffered text writer that replaces a file in one step. Output goes to a
+// temporary file beside the target; commit() syncs it and renames it over
+// the target, so readers and crashes only ever see the old or the new file.
+// A writer destroyed without commit() removes its temporary file.
+//
+// Numbers are formatted with std::to_chars; doubles use the same text as an
+// ostream at its default precision.
+class AtomicFileWriter {
+private:
+    std::string path;
+    std::string tempPath;
+    std::FILE* out = nullptr;
+    std::string buffer;
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    void flushBuffer();
+    void discard();
+
+public:
+    class WriteException : public std::runtime_error {
+    public:
+        explicit WriteException(const std::string& message);
+    };
+
+    // Throws WriteException if the temporary file cannot be created
+    explicit AtomicFileWriter(const std::string& path);
+    ~AtomicFileWriter();
+
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    AtomicFileWriter& operator<<(std::string_view text);
+    AtomicFileWriter& operator<<(char c);
+    AtomicFileWriter& operator<<(double value);
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> &&
+                                                      !std::is_same_v<T, bool> &&
+                                                      !std::is_same_v<T, char>>>
+    AtomicFileWriter& operator<<(T value);
+
+    // Writes everything out and moves it into place; throws WriteException
+    // and leaves the target untouched on failure
+    void commit();
+};
+
+template <typename T, typename>
+AtomicFileWriter& AtomicFileWriter::operator<<(T value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+} // namespace diet
+
+#endif // ATOMIC_FILE_WRITER_H
@@ -1,10 +1,14 @@
 #include "DailyLog.h"
+#include "FoodDatabase.h"
+#include "AtomicFileWriter.h"
+#include "../Food/NutrientKernels.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <iomanip>
-#include <regex>
 #include <ctime>
+#include <algorithm>
+#include <iterator>
 
 namespace diet {
 
@@ -12,8 +16,30 @@ namespace diet {
 DailyLog::LogException::LogException(const std::string& message)
     : std::runtime_error(message) {}
 
+namespace {
+
+// Hand-edited log files may pad the ID, e.g. "2025-03-28; b_1;1"
+std::string_view trimId(std::string_view id) {
+    size_t first = id.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    size_t last = id.find_last_not_of(" \t\r\n");
+    return id.substr(first, last - first + 1);
+}
+
+Date parseDateOrThrow(const std::string& text) {
+    Date date;
+    if (!Date::parse(text, date)) {
+        throw DailyLog::LogException("Invalid date format. Use YYYY-MM-DD");
+    }
+    return date;
+}
+
+} // namespace
+
 // LogEntry implementation with validation
-LogEntry::LogEntry(const std::string& date, const std::string& foodId, double servings)
+LogEntry::LogEntry(const Date& date, const std::string& foodId, double servings)
     : date(date), foodId(foodId), servings(servings) {
     if (servings <= 0) {
         throw DailyLog::LogException("Servings must be a positive number");
@@ -21,30 +47,45 @@ LogEntry::LogEntry(const std::string& date, const std::string& foodId, double se
     if (foodId.empty()) {
         throw DailyLog::LogException("Food ID cannot be empty");
     }
-    if (!DailyLog::isValidDateFormat(date)) {
-        throw DailyLog::LogException("Invalid date format. Use YYYY-MM-DD");
-    }
 }
 
+LogEntry::LogEntry(const std::string& date, const std::string& foodId, double servings)
+    : LogEntry(parseDateOrThrow(date), foodId, servings) {}
+
 // DailyLog implementation
-DailyLog::DailyLog(const std::string& file) : logFile(file) {}
+DailyLog::DailyLog(const std::string& file) : logFile(file), liveTree(1), journal(file + ".journal") {}
 
 bool DailyLog::isValidDateFormat(const std::string& date) {
-    std::regex datePattern(R"(\d{4}-\d{2}-\d{2})");
-    return std::regex_match(date, datePattern);
+    Date parsed;
+    return Date::parse(date, parsed);
 }
 
-void DailyLog::loadLog() {
+bool DailyLog::loadLog(std::ostream& diagnostics) {
+    entries.clear();
+    generation = 0;
+
+    // The journal is reopened against the new base on the first change
+    journal.close();
+
     std::ifstream inFile(logFile);
-    if (!inFile) {
-        std::cerr << "Warning: Could not open log file: " << logFile << std::endl;
-        return;
+    bool found = static_cast<bool>(inFile);
+    baseCurrent = found;
+    if (!found) {
+        diagnostics << "Warning: Could not open log file: " << logFile << std::endl;
     }
     
-    entries.clear();
     std::string line;
+    const std::string generationPrefix = "# Generation: ";
     
-    while (std::getline(inFile, line)) {
+    while (found && std::getline(inFile, line)) {
+        if (line.rfind(generationPrefix, 0) == 0) {
+            try {
+                generation = std::stoull(line.substr(generationPrefix.size()));
+            } catch (const std::exception&) {
+                diagnostics << "Ignoring invalid generation line: " << line << std::endl;
+            }
+            continue;
+        }
         if (line.empty() || line[0] == '#') continue;
         
         std::stringstream ss(line);
@@ -58,44 +99,237 @@ void DailyLog::loadLog() {
                 double servings = std::stod(servingsStr);
                 entries.emplace_back(dateStr, foodIdStr, servings);
             } catch (const std::exception& e) {
-                std::cerr << "Error parsing log entry: " << line << " - " << e.what() << std::endl;
+                diagnostics << "Error parsing log entry: " << line << " - " << e.what() << std::endl;
             }
         } else {
-            std::cerr << "Skipping invalid log entry: " << line << std::endl;
+            diagnostics << "Skipping invalid log entry: " << line << std::endl;
         }
     }
     
     inFile.close();
-}
+    removed.assign(entries.size(), 0);
+    removedCount = 0;
+    rebuildDateIndex();
 
-void DailyLog::saveLog() const {
-    std::ofstream outFile(logFile);
-    if (!outFile) {
-        throw LogException("Failed to open daily log file for writing: " + logFile);
+    // Replay changes made since the base file was last compacted; the next
+    // save folds them into the base
+    auto records = journal.readRecords(generation, diagnostics);
+    if (!records.empty()) {
+        baseCurrent = false;
     }
-    
-    outFile << "# Format: date;foodId;servings\n";
-    time_t now = std::time(nullptr);
-    outFile << "# Generated on: " << std::put_time(std::localtime(&now), 
-                                                 "%Y-%m-%d %H:%M:%S") << "\n";
-    
+    for (const auto& record : records) {
+        try {
+            if (record.type == JournalRecord::Type::ADD) {
+                appendSlot(LogEntry(record.date, record.foodId, record.servings));
+            } else if (!applyRemove(record.index)) {
+                diagnostics << "Skipping journal removal of missing entry " << record.index << std::endl;
+            }
+        } catch (const std::exception& e) {
+            diagnostics << "Error replaying journal record: " << e.what() << std::endl;
+        }
+    }
+
+    if (removedCount > 0) {
+        compact();
+    }
+
+    foodUses.clear();
     for (const auto& entry : entries) {
-        outFile << entry.date << ";" << entry.foodId << ";" << entry.servings << "\n";
+        countUse(entry, 1);
     }
-    
-    outFile.close();
+    rebuildTotals();
+    return found;
 }
 
-void DailyLog::addEntry(const LogEntry& entry) {
+void DailyLog::rebuildDateIndex() {
+    // Linear-time Fenwick construction: push each node into its parent
+    size_t n = entries.size();
+    liveTree.assign(n + 1, 0);
+    for (size_t i = 1; i <= n; ++i) {
+        liveTree[i] += removed[i - 1] ? 0 : 1;
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= n) {
+            liveTree[parent] += liveTree[i];
+        }
+    }
+
+    days.clear();
+    for (uint32_t slot = 0; slot < n; ++slot) {
+        if (!removed[slot]) {
+            days[entries[slot].date].push_back(slot);
+        }
+    }
+}
+
+uint32_t DailyLog::rankOf(uint32_t slot) const {
+    uint32_t rank = 0;
+    for (size_t i = slot; i > 0; i -= i & (~i + 1)) {
+        rank += liveTree[i];
+    }
+    return rank;
+}
+
+uint32_t DailyLog::slotAt(uint32_t index) const {
+    // Descend the tree for the first slot with index + 1 live slots up to it
+    size_t n = entries.size();
+    size_t step = 1;
+    while (step * 2 <= n) {
+        step *= 2;
+    }
+    size_t position = 0;
+    uint32_t remaining = index + 1;
+    for (; step > 0; step /= 2) {
+        if (position + step <= n && liveTree[position + step] < remaining) {
+            position += step;
+            remaining -= liveTree[position];
+        }
+    }
+    return static_cast<uint32_t>(position);
+}
+
+uint32_t DailyLog::appendSlot(const LogEntry& entry) {
+    uint32_t slot = static_cast<uint32_t>(entries.size());
     entries.push_back(entry);
+    removed.push_back(0);
+
+    // Node n covers slots (n - lowbit(n), n]: the new slot plus a range of
+    // existing ones recoverable from prefix counts
+    size_t n = slot + 1;
+    liveTree.push_back(1 + rankOf(slot) - rankOf(static_cast<uint32_t>(n - (n & (~n + 1)))));
+
+    // The newest slot is the largest, so it goes last within its day
+    days[entry.date].push_back(slot);
+    return slot;
+}
+
+void DailyLog::removeSlot(uint32_t slot) {
+    removed[slot] = 1;
+    ++removedCount;
+    for (size_t i = slot + 1; i < liveTree.size(); i += i & (~i + 1)) {
+        --liveTree[i];
+    }
+
+    auto day = days.find(entries[slot].date);
+    auto& slots = day->second;
+    slots.erase(std::lower_bound(slots.begin(), slots.end(), slot));
+    if (slots.empty()) {
+        days.erase(day);
+    }
+}
+
+bool DailyLog::applyRemove(int index) {
+    if (index < 0 || static_cast<size_t>(index) >= liveCount()) {
+        return false;
+    }
+    removeSlot(slotAt(static_cast<uint32_t>(index)));
+    return true;
+}
+
+void DailyLog::compact() {
+    size_t next = 0;
+    for (size_t slot = 0; slot < entries.size(); ++slot) {
+        if (!removed[slot]) {
+            if (next != slot) {
+                entries[next] = std::move(entries[slot]);
+            }
+            ++next;
+        }
+    }
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(next), entries.end());
+    removed.assign(next, 0);
+    removedCount = 0;
+    rebuildDateIndex();
+}
+
+void DailyLog::saveLog() {
+    if (baseCurrent && journal.getRecordCount() == 0) {
+        return;
+    }
+
+    // Write the next generation beside the old file and swap it in, so a
+    // crash leaves either the old base plus its journal or the new base
+    try {
+        AtomicFileWriter outFile(logFile);
+        outFile << "# Format: date;foodId;servings\n";
+
+        char generatedOn[32];
+        time_t now = std::time(nullptr);
+        size_t length = std::strftime(generatedOn, sizeof(generatedOn), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+        outFile << "# Generated on: " << std::string_view(generatedOn, length) << '\n';
+        outFile << "# Generation: " << generation + 1 << '\n';
+
+        for (size_t slot = 0; slot < entries.size(); ++slot) {
+            if (removed[slot]) {
+                continue;
+            }
+            const auto& entry = entries[slot];
+            outFile << entry.date.toString() << ';' << entry.foodId << ';' << entry.servings << '\n';
+        }
+        outFile.commit();
+    } catch (const AtomicFileWriter::WriteException& e) {
+        throw LogException(e.what());
+    }
+    baseCurrent = true;
+
+    // The base now holds everything, so start an empty journal against it
+    ++generation;
+    try {
+        journal.reset(generation);
+    } catch (const std::exception& e) {
+        throw LogException(e.what());
+    }
+}
+
+void DailyLog::journalChange(const std::function<void()>& append) {
+    try {
+        if (!journal.isOpen()) {
+            journal.open(generation);
+        }
+        append();
+    } catch (const std::exception& e) {
+        throw LogException(e.what());
+    }
+}
+
+void DailyLog::compactIfJournalFull() {
+    if (journal.getRecordCount() >= COMPACTION_THRESHOLD) {
+        saveLog();
+    }
+}
+
+void DailyLog::addEntry(const LogEntry& entry) {
+    // Journal first, so a failed append leaves memory as it was
+    journalChange([&] { journal.appendAdd(entry.date, entry.foodId, entry.servings); });
+    appendSlot(entry);
+
+    NutrientVector nutrients;
+    if (nutrientsOf(entry, nutrients)) {
+        totals.add(entry.date, nutrients, entry.servings);
+    }
+    countUse(entry, 1);
+    compactIfJournalFull();
 }
 
 bool DailyLog::removeEntry(int index) {
-    if (index >= 0 && index < static_cast<int>(entries.size())) {
-        entries.erase(entries.begin() + index);
-        return true;
+    if (index < 0 || static_cast<size_t>(index) >= liveCount()) {
+        return false;
     }
-    return false;
+
+    journalChange([&] { journal.appendRemove(index); });
+
+    uint32_t slot = slotAt(static_cast<uint32_t>(index));
+    const LogEntry& entry = entries[slot];
+    NutrientVector nutrients;
+    if (nutrientsOf(entry, nutrients)) {
+        totals.add(entry.date, nutrients, -entry.servings);
+    }
+    countUse(entry, -1);
+    removeSlot(slot);
+    if (removedCount > liveCount() / 4 + 64) {
+        compact();
+    }
+    compactIfJournalFull();
+    return true;
 }
 
 void DailyLog::displayLog() const {
@@ -110,9 +344,13 @@ void DailyLog::displayLog() const {
               << std::setw(10) << "Servings" << "\n";
     std::cout << "-----------------------------------\n";
     
-    for (size_t i = 0; i < entries.size(); ++i) {
-        const auto& entry = entries[i];
-        std::cout << "[" << i << "] " 
+    size_t i = 0;
+    for (size_t slot = 0; slot < entries.size(); ++slot) {
+        if (removed[slot]) {
+            continue;
+        }
+        const auto& entry = entries[slot];
+        std::cout << "[" << i++ << "] " 
                   << std::left << std::setw(12) << entry.date 
                   << std::setw(10) << entry.foodId 
                   << std::setw(10) << entry.servings << "\n";
@@ -120,18 +358,164 @@ void DailyLog::displayLog() const {
     std::cout << "===================================\n";
 }
 
-std::vector<LogEntry> DailyLog::getEntriesForDate(const std::string& date) const {
-    std::vector<LogEntry> result;
-    for (const auto& entry : entries) {
-        if (entry.date == date) {
-            result.push_back(entry);
+uint32_t EntryRange::iterator::index() const {
+    return log->rankOf(day->second[position]);
+}
+
+EntryRange DailyLog::rangeOf(EntryRange::DayMap::const_iterator first,
+                            EntryRange::DayMap::const_iterator last) const {
+    size_t count = 0;
+    for (auto day = first; day != last; ++day) {
+        count += day->second.size();
+    }
+    return EntryRange(this, &entries, first, last, count);
+}
+
+EntryRange DailyLog::getEntriesForDate(const Date& date) const {
+    return getEntriesBetween(date, date);
+}
+
+EntryRange DailyLog::getEntriesBetween(const Date& from, const Date& to) const {
+    if (to < from) {
+        return EntryRange();
+    }
+    return rangeOf(days.lower_bound(from), days.upper_bound(to));
+}
+
+const Food* DailyLog::foodOf(const LogEntry& entry) const {
+    if (!foodDb) {
+        return nullptr;
+    }
+
+    std::string_view id = trimId(entry.foodId);
+    return id.empty() ? nullptr : foodDb->findFoodHandle(id);
+}
+
+bool DailyLog::nutrientsOf(const LogEntry& entry, NutrientVector& nutrients) const {
+    const Food* food = foodOf(entry);
+    if (!food) {
+        return false;
+    }
+    nutrients = food->getNutrients();
+    return true;
+}
+
+size_t DailyLog::accumulateEntries(const EntryRange& range, NutrientVector& out) const {
+    // Basic foods are batched as (row, servings) pairs for the column
+    // kernel; composites fall back to their cached totals
+    thread_local std::vector<uint32_t> rows;
+    thread_local std::vector<double> servings;
+    rows.clear();
+    servings.clear();
+
+    size_t resolved = 0;
+    for (const auto& entry : range) {
+        const Food* food = foodOf(entry);
+        if (!food) {
+            continue;
+        }
+        ++resolved;
+        uint32_t row;
+        if (foodDb->findNutrientRow(*food, row)) {
+            rows.push_back(row);
+            servings.push_back(entry.servings);
+        } else {
+            out.addScaled(food->getNutrients(), entry.servings);
+        }
+    }
+    if (!rows.empty()) {
+        NutrientKernels::accumulate(foodDb->getNutrientColumns(), rows.data(), servings.data(), rows.size(), out);
+    }
+    return resolved;
+}
+
+NutrientVector DailyLog::sumEntries(const EntryRange& range) const {
+    NutrientVector sum;
+    accumulateEntries(range, sum);
+    return sum;
+}
+
+void DailyLog::setFoodDatabase(const FoodDatabase* db) {
+    foodDb = db;
+    rebuildTotals();
+}
+
+void DailyLog::rebuildTotals() {
+    totals.clear();
+    if (!foodDb) {
+        return;
+    }
+    for (auto day = days.cbegin(); day != days.cend(); ++day) {
+        NutrientVector dayTotal;
+        if (accumulateEntries(rangeOf(day, std::next(day)), dayTotal) > 0) {
+            totals.add(day->first, dayTotal, 1.0);
+        }
+    }
+}
+
+void DailyLog::refreshTotals() {
+    rebuildTotals();
+}
+
+void DailyLog::countUse(const LogEntry& entry, int delta) {
+    std::string id(trimId(entry.foodId));
+    if (delta > 0) {
+        foodUses[id] += static_cast<uint32_t>(delta);
+        return;
+    }
+    auto uses = foodUses.find(id);
+    if (uses != foodUses.end() && (uses->second -= static_cast<uint32_t>(-delta)) == 0) {
+        foodUses.erase(uses);
+    }
+}
+
+bool DailyLog::refersTo(std::string_view foodId) const {
+    return foodUses.count(std::string(trimId(foodId))) > 0;
+}
+
+NutrientVector DailyLog::getNutrientTotalsForDate(const Date& date) const {
+    return totals.totalFor(date);
+}
+
+NutrientVector DailyLog::getNutrientTotalsBetween(const Date& from, const Date& to) const {
+    return totals.sumBetween(from, to);
+}
+
+std::vector<NutrientSummary> DailyLog::summarize(const Date& from, const Date& to, SummaryPeriod period) const {
+    std::vector<NutrientSummary> buckets;
+    for (Date start = from; start <= to;) {
+        Date end = start;
+        if (period == SummaryPeriod::WEEK) {
+            end = start.addDays(6 - static_cast<int32_t>(start.weekday()));
+        } else if (period == SummaryPeriod::MONTH) {
+            int year;
+            unsigned month, day;
+            start.toCivil(year, month, day);
+            end = start.addDays(static_cast<int32_t>(Date::daysInMonth(year, month) - day));
+        }
+        if (to < end) {
+            end = to;
+        }
+
+        buckets.push_back({start, end, totals.sumBetween(start, end)});
+        start = end.addDays(1);
+    }
+    return buckets;
+}
+
+std::vector<LogEntry> DailyLog::getAllEntries() const {
+    std::vector<LogEntry> live;
+    live.reserve(liveCount());
+    for (size_t slot = 0; slot < entries.size(); ++slot) {
+        if (!removed[slot]) {
+            live.push_back(entries[slot]);
         }
     }
-    return result;
+    return live;
 }
 
-const std::vector<LogEntry>& DailyLog::getAllEntries() const {
-    return entries;
+size_t DailyLog::getEntryCount() const {
+    return liveCount();
 }
 
 } // namespace diet
@@ -2,50 +2,245 @@
 #define DAILY_LOG_H
 
 #include <string>
+#include <iostream>
 #include <vector>
 #include <memory>
 #include <stdexcept>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+#include <map>
+#include "../Food/NutrientVector.h"
+#include "LogJournal.h"
+#include "Date.h"
+#include "DailyTotals.h"
 
 namespace diet
 {
 
+    class FoodDatabase;
+    class DailyLog;
+    class Food;
+
     // Define a LogEntry structure with strong typing
     struct LogEntry
     {
-        std::string date;
+        Date date;
         std::string foodId;
         double servings;
 
-        // Constructor for validation
+        // Constructors for validation; the string form must be YYYY-MM-DD
+        LogEntry(const Date &date, const std::string &foodId, double servings);
         LogEntry(const std::string &date, const std::string &foodId, double servings);
     };
 
+    // Non-owning view of log entries selected through the date index, in
+    // date order and, within a day, in log order. Invalidated by any change
+    // to the log it came from.
+    class EntryRange
+    {
+    public:
+        // Slots of each day's entries, ascending; days without entries are
+        // not kept
+        using DayMap = std::map<Date, std::vector<uint32_t>>;
+
+        class iterator
+        {
+        private:
+            const DailyLog *log = nullptr;
+            const std::vector<LogEntry> *entries = nullptr;
+            DayMap::const_iterator day;
+            size_t position = 0;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = LogEntry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const LogEntry *;
+            using reference = const LogEntry &;
+
+            iterator() = default;
+            iterator(const DailyLog *log, const std::vector<LogEntry> *entries, DayMap::const_iterator day)
+                : log(log), entries(entries), day(day) {}
+
+            reference operator*() const { return (*entries)[day->second[position]]; }
+            pointer operator->() const { return &(*entries)[day->second[position]]; }
+            iterator &operator++()
+            {
+                if (++position == day->second.size())
+                {
+                    ++day;
+                    position = 0;
+                }
+                return *this;
+            }
+            iterator operator++(int)
+            {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+            bool operator==(const iterator &other) const { return day == other.day && position == other.position; }
+            bool operator!=(const iterator &other) const { return !(*this == other); }
+
+            // Position of the entry in getAllEntries() order; O(log n)
+            uint32_t index() const;
+        };
+
+        EntryRange() = default;
+        EntryRange(const DailyLog *log, const std::vector<LogEntry> *entries, DayMap::const_iterator first,
+                   DayMap::const_iterator last, size_t count)
+            : log(log), entries(entries), first(first), last(last), count(count) {}
+
+        iterator begin() const { return iterator(log, entries, first); }
+        iterator end() const { return iterator(log, entries, last); }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+    private:
+        const DailyLog *log = nullptr;
+        const std::vector<LogEntry> *entries = nullptr;
+        DayMap::const_iterator first, last;
+        size_t count = 0;
+    };
+
+    // Bucket size for DailyLog::summarize
+    enum class SummaryPeriod
+    {
+        DAY,
+        WEEK, // Monday to Sunday
+        MONTH
+    };
+
+    // Totals for one bucket, clipped to the requested range
+    struct NutrientSummary
+    {
+        Date start;
+        Date end;
+        NutrientVector totals;
+    };
+
     class DailyLog
     {
     private:
+        friend class EntryRange;
+
+        // Entries in log order. A removed entry keeps its slot, so nothing
+        // else moves, until removed slots reach a quarter of the live ones
+        // and compact() drops them all in one pass.
         std::vector<LogEntry> entries;
+        std::vector<uint8_t> removed;
+        size_t removedCount = 0;
         std::string logFile;
 
+        // 1-based Fenwick tree counting live slots, mapping between a slot
+        // and its position in getAllEntries() order in O(log n)
+        std::vector<uint32_t> liveTree;
+
+        // Each day's slots, so a change touches only its own day
+        EntryRange::DayMap days;
+
+        // Changes since the last save go to an append-only journal beside
+        // logFile; generation identifies the base file the journal extends.
+        // The journal is only opened (and created) by the first change, so
+        // loading a log never writes next to it.
+        LogJournal journal;
+        uint64_t generation = 0;
+
+        // True while logFile holds every entry apart from the journal's
+        // records, so saving without records has nothing to compact
+        bool baseCurrent = false;
+
+        // Journal records after which addEntry/removeEntry compact the log
+        static constexpr size_t COMPACTION_THRESHOLD = 4096;
+
+        // Per-day nutrient totals, maintained while a database is attached
+        const FoodDatabase *foodDb = nullptr;
+        DailyTotals totals;
+
+        // Number of entries naming each (trimmed) food ID, so a change to a
+        // food the log never mentions can skip refreshTotals
+        std::unordered_map<std::string, uint32_t> foodUses;
+        void countUse(const LogEntry &entry, int delta);
+
+        // False if the entry's food is unknown or no database is attached
+        bool nutrientsOf(const LogEntry &entry, NutrientVector &nutrients) const;
+        const Food *foodOf(const LogEntry &entry) const;
+        void rebuildTotals();
+
+        // out += servings-weighted nutrients of range; returns how many
+        // entries resolved to a food
+        size_t accumulateEntries(const EntryRange &range, NutrientVector &out) const;
+
+        // Records a change before it is applied, so memory never holds a
+        // change the journal lacks; throws LogException if it cannot
+        void journalChange(const std::function<void()> &append);
+        void compactIfJournalFull();
+
+        size_t liveCount() const { return entries.size() - removedCount; }
+        uint32_t rankOf(uint32_t slot) const; // live slots before slot
+        uint32_t slotAt(uint32_t index) const; // slot of the index-th live entry
+        uint32_t appendSlot(const LogEntry &entry);
+        void removeSlot(uint32_t slot);
+        bool applyRemove(int index);
+        void compact();
+        void rebuildDateIndex();
+        EntryRange rangeOf(EntryRange::DayMap::const_iterator first,
+                           EntryRange::DayMap::const_iterator last) const;
+
     public:
-        // Helper method to validate date format
+        // Helper method to validate date format and calendar validity
         static bool isValidDateFormat(const std::string &date);
         // Constructor that takes the log file path
         explicit DailyLog(const std::string &file);
 
-        // File operations
-        void loadLog();
-        void saveLog() const;
+        // File operations; loadLog returns false if the file could not be read
+        // and reports skipped lines to diagnostics.
+        // saveLog compacts the journal into a new base file, and does nothing
+        // when the base file is already current.
+        bool loadLog(std::ostream &diagnostics = std::cerr);
+        void saveLog();
 
-        // Log entry management
+        // Log entry management. Both cost O(log n) plus the entries of the
+        // day changed; removal compacts now and then, amortised O(1).
         void addEntry(const LogEntry &entry);
         bool removeEntry(int index);
 
         // Display and query methods
         void displayLog() const;
-        std::vector<LogEntry> getEntriesForDate(const std::string &date) const;
+        EntryRange getEntriesForDate(const Date &date) const;
+
+        // Entries dated from..to inclusive, ordered by date
+        EntryRange getEntriesBetween(const Date &from, const Date &to) const;
+
+        // Resolves entries against db for the nutrient queries below and
+        // keeps per-day totals current as entries change. Call
+        // refreshTotals after changing foods the log refers to.
+        void setFoodDatabase(const FoodDatabase *db);
+        void refreshTotals();
+
+        // Whether any entry names the food, i.e. whether changing or
+        // removing it can affect the totals
+        bool refersTo(std::string_view foodId) const;
+
+        // Servings-weighted nutrient totals; O(log n) in the number of
+        // months the log spans. Entries whose food is unknown count as zero.
+        NutrientVector getNutrientTotalsForDate(const Date &date) const;
+        NutrientVector getNutrientTotalsBetween(const Date &from, const Date &to) const;
+
+        // Servings-weighted totals of an arbitrary selection, computed from
+        // the entries themselves in batches (see NutrientKernels)
+        NutrientVector sumEntries(const EntryRange &range) const;
+
+        // Totals per day, week or month between from and to inclusive
+        std::vector<NutrientSummary> summarize(const Date &from, const Date &to, SummaryPeriod period) const;
 
-        // Accessor for all entries
-        const std::vector<LogEntry> &getAllEntries() const;
+        // Copy of every entry in log order, the order indices refer to
+        std::vector<LogEntry> getAllEntries() const;
+        size_t getEntryCount() const;
 
         // Exception class for log errors
         class LogException : public std::runtime_error
@@ -0,0 +1,124 @@
+#include "DailyTotals.h"
+#include <algorithm>
+
+namespace diet {
+
+int32_t DailyTotals::monthOf(const Date& date, unsigned& day) {
+    int year;
+    unsigned month;
+    date.toCivil(year, month, day);
+    return year * 12 + static_cast<int32_t>(month) - 1;
+}
+
+void DailyTotals::clear() {
+    buckets.clear();
+    tree.clear();
+    firstMonth = 0;
+}
+
+void DailyTotals::reserveMonth(int32_t month) {
+    int32_t lastMonth = firstMonth + static_cast<int32_t>(capacity()) - 1;
+    if (!tree.empty() && month >= firstMonth && month <= lastMonth) {
+        return;
+    }
+
+    // Double the range (at least) towards the new month, so a run of
+    // earlier or later months only rebuilds O(log n) times
+    size_t grown;
+    if (tree.empty()) {
+        grown = 16;
+        firstMonth = month;
+    } else if (month < firstMonth) {
+        grown = std::max(capacity() * 2, static_cast<size_t>(lastMonth - month) + 1);
+        firstMonth = lastMonth - static_cast<int32_t>(grown) + 1;
+    } else {
+        grown = std::max(capacity() * 2, static_cast<size_t>(month - firstMonth) + 1);
+    }
+
+    // Linear-time Fenwick construction: push each node into its parent
+    tree.assign(grown + 1, NutrientVector{});
+    for (const auto& bucket : buckets) {
+        NutrientVector& node = tree[static_cast<size_t>(bucket.first - firstMonth) + 1];
+        for (const auto& day : bucket.second) {
+            node.addScaled(day, 1.0);
+        }
+    }
+    for (size_t i = 1; i <= grown; ++i) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent <= grown) {
+            tree[parent].addScaled(tree[i], 1.0);
+        }
+    }
+}
+
+void DailyTotals::treeAdd(size_t slot, const NutrientVector& nutrients, double scale) {
+    for (size_t i = slot + 1; i < tree.size(); i += i & (~i + 1)) {
+        tree[i].addScaled(nutrients, scale);
+    }
+}
+
+NutrientVector DailyTotals::prefixSum(size_t count) const {
+    NutrientVector sum;
+    for (size_t i = count; i > 0; i -= i & (~i + 1)) {
+        sum.addScaled(tree[i], 1.0);
+    }
+    return sum;
+}
+
+NutrientVector DailyTotals::monthsBetween(int32_t first, int32_t last) const {
+    // Months outside the tree's range have no entries
+    int32_t lastMonth = firstMonth + static_cast<int32_t>(capacity()) - 1;
+    first = std::max(first, firstMonth);
+    last = std::min(last, lastMonth);
+    if (tree.empty() || last < first) {
+        return NutrientVector{};
+    }
+    NutrientVector sum = prefixSum(static_cast<size_t>(last - firstMonth) + 1);
+    sum.addScaled(prefixSum(static_cast<size_t>(first - firstMonth)), -1.0);
+    return sum;
+}
+
+NutrientVector DailyTotals::daysBetween(int32_t month, unsigned first, unsigned last) const {
+    NutrientVector sum;
+    auto bucket = buckets.find(month);
+    if (bucket != buckets.end()) {
+        for (unsigned day = first; day <= last; ++day) {
+            sum.addScaled(bucket->second[day - 1], 1.0);
+        }
+    }
+    return sum;
+}
+
+void DailyTotals::add(const Date& date, const NutrientVector& nutrients, double scale) {
+    unsigned day;
+    int32_t month = monthOf(date, day);
+    reserveMonth(month);
+    buckets[month][day - 1].addScaled(nutrients, scale);
+    treeAdd(static_cast<size_t>(month - firstMonth), nutrients, scale);
+}
+
+NutrientVector DailyTotals::totalFor(const Date& date) const {
+    unsigned day;
+    auto bucket = buckets.find(monthOf(date, day));
+    return bucket == buckets.end() ? NutrientVector{} : bucket->second[day - 1];
+}
+
+NutrientVector DailyTotals::sumBetween(const Date& from, const Date& to) const {
+    if (to < from) {
+        return NutrientVector{};
+    }
+    unsigned fromDay, toDay;
+    int32_t fromMonth = monthOf(from, fromDay);
+    int32_t toMonth = monthOf(to, toDay);
+    if (fromMonth == toMonth) {
+        return daysBetween(fromMonth, fromDay, toDay);
+    }
+
+    // Partial months at either end, whole months through the tree
+    NutrientVector sum = daysBetween(fromMonth, fromDay, 31);
+    sum.addScaled(daysBetween(toMonth, 1, toDay), 1.0);
+    sum.addScaled(monthsBetween(fromMonth + 1, toMonth - 1), 1.0);
+    return sum;
+}
+
+} // namespace diet
@@ -0,0 +1,50 @@
+#ifndef DAILY_TOTALS_H
+#define DAILY_TOTALS_H
+
+#include "Date.h"
+#include "../Food/NutrientVector.h"
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace diet {
+
+// Per-day nutrient totals kept in month buckets, one fixed slot per day of
+// the month, with a Fenwick tree of prefix sums over a range of months.
+// Any day, earlier or later than those already logged, lands in its own
+// slot, so updates cost O(log months) and date-range sums O(log months)
+// plus the partial months at either end. The month range grows
+// geometrically, so rebuilding the tree on growth is amortised away.
+class DailyTotals {
+private:
+    using MonthBucket = std::array<NutrientVector, 31>;
+
+    // Months are counted as year * 12 + month - 1
+    std::unordered_map<int32_t, MonthBucket> buckets;
+    std::vector<NutrientVector> tree; // 1-based Fenwick tree over months
+    int32_t firstMonth = 0;           // month held by tree slot 1
+
+    static int32_t monthOf(const Date& date, unsigned& day);
+    size_t capacity() const { return tree.empty() ? 0 : tree.size() - 1; }
+
+    void reserveMonth(int32_t month);
+    void treeAdd(size_t slot, const NutrientVector& nutrients, double scale);
+    NutrientVector prefixSum(size_t count) const; // sum of the first count months
+    NutrientVector monthsBetween(int32_t first, int32_t last) const; // inclusive
+    NutrientVector daysBetween(int32_t month, unsigned first, unsigned last) const; // inclusive
+
+public:
+    void clear();
+
+    // dayTotals[date] += nutrients * scale; a negative scale retracts
+    void add(const Date& date, const NutrientVector& nutrients, double scale);
+
+    NutrientVector totalFor(const Date& date) const;
+    NutrientVector sumBetween(const Date& from, const Date& to) const; // inclusive
+};
+
+} // namespace diet
+
+#endif // DAILY_TOTALS_H
@@ -0,0 +1,98 @@
+#include "Date.h"
+#include <stdexcept>
+
+namespace diet {
+
+bool Date::isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+unsigned Date::daysInMonth(int year, unsigned month) {
+    static const unsigned lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && isLeapYear(year)) {
+        return 29;
+    }
+    return lengths[month - 1];
+}
+
+// Civil <-> day number conversions after Howard Hinnant's days_from_civil
+// and civil_from_days, restricted to the years a YYYY field can hold
+Date Date::fromCivil(int year, unsigned month, unsigned day) {
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+        throw std::invalid_argument("Invalid calendar date");
+    }
+    int y = month <= 2 ? year - 1 : year;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yearOfEra = static_cast<unsigned>(y - era * 400);
+    unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return Date(era * 146097 + static_cast<int32_t>(dayOfEra) - 719468);
+}
+
+Date Date::fromDayNumber(int32_t days) {
+    return Date(days);
+}
+
+void Date::toCivil(int& year, unsigned& month, unsigned& day) const {
+    int32_t z = days + 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned dayOfEra = static_cast<unsigned>(z - era * 146097);
+    unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    unsigned mp = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+bool Date::parse(std::string_view text, Date& out) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') {
+        return false;
+    }
+
+    auto digits = [&text](size_t from, size_t count, unsigned& value) {
+        value = 0;
+        for (size_t i = from; i < from + count; ++i) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            value = value * 10 + static_cast<unsigned>(text[i] - '0');
+        }
+        return true;
+    };
+
+    unsigned year, month, day;
+    if (!digits(0, 4, year) || !digits(5, 2, month) || !digits(8, 2, day)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(static_cast<int>(year), month)) {
+        return false;
+    }
+
+    out = fromCivil(static_cast<int>(year), month, day);
+    return true;
+}
+
+std::string Date::toString() const {
+    int year;
+    unsigned month, day;
+    toCivil(year, month, day);
+
+    std::string text = "0000-00-00";
+    for (int i = 3, y = year; i >= 0; --i, y /= 10) text[i] = static_cast<char>('0' + y % 10);
+    text[5] = static_cast<char>('0' + month / 10);
+    text[6] = static_cast<char>('0' + month % 10);
+    text[8] = static_cast<char>('0' + day / 10);
+    text[9] = static_cast<char>('0' + day % 10);
+    return text;
+}
+
+unsigned Date::weekday() const {
+    // 1970-01-01 was a Thursday (3 when Monday is 0)
+    int32_t shifted = (days + 3) % 7;
+    return static_cast<unsigned>(shifted < 0 ? shifted + 7 : shifted);
+}
+
+std::ostream& operator<<(std::ostream& os, const Date& date) {
+    return os << date.toString();
+}
+
+} // namespace diet
@@ -0,0 +1,55 @@
+#ifndef DATE_H
+#define DATE_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstdint>
+
+namespace diet {
+
+// Calendar date packed into a day number (days since 1970-01-01 in the
+// proleptic Gregorian calendar), so comparisons and day arithmetic are
+// integer operations. Text form is always YYYY-MM-DD.
+class Date {
+private:
+    int32_t days;
+
+    explicit Date(int32_t days) : days(days) {}
+
+public:
+    Date() : days(0) {}
+
+    // Strict YYYY-MM-DD parse that also rejects impossible dates such as
+    // 2025-02-30; returns false and leaves out untouched on failure
+    static bool parse(std::string_view text, Date& out);
+
+    // Throws std::invalid_argument if the components are not a real date
+    static Date fromCivil(int year, unsigned month, unsigned day);
+    static Date fromDayNumber(int32_t days);
+
+    static bool isLeapYear(int year);
+    static unsigned daysInMonth(int year, unsigned month);
+
+    void toCivil(int& year, unsigned& month, unsigned& day) const;
+    std::string toString() const;
+    int32_t getDayNumber() const { return days; }
+
+    // Day of week with Monday = 0 ... Sunday = 6
+    unsigned weekday() const;
+
+    Date addDays(int32_t count) const { return Date(days + count); }
+
+    bool operator==(const Date& other) const { return days == other.days; }
+    bool operator!=(const Date& other) const { return days != other.days; }
+    bool operator<(const Date& other) const { return days < other.days; }
+    bool operator<=(const Date& other) const { return days <= other.days; }
+    bool operator>(const Date& other) const { return days > other.days; }
+    bool operator>=(const Date& other) const { return days >= other.days; }
+};
+
+std::ostream& operator<<(std::ostream& os, const Date& date);
+
+} // namespace diet
+
+#endif // DATE_H
@@ -0,0 +1,12 @@
+#include "FoodArena.h"
+
+namespace diet {
+
+FoodArena::FoodArena(size_t initialSize)
+    : resource(initialSize > 0 ? initialSize : 1) {}
+
+std::pmr::memory_resource* FoodArena::getResource() {
+    return &resource;
+}
+
+} // namespace diet
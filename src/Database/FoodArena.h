@@ -0,0 +1,72 @@
+#ifndef FOOD_ARENA_H
+#define FOOD_ARENA_H
+
+#include <memory>
+#include <memory_resource>
+#include <cstddef>
+#include <utility>
+
+namespace diet {
+
+// Bump allocator that a FoodDatabase load carves its foods and their text
+// from. Nothing is freed individually; the blocks go back to the heap in one
+// go when the last food built from the arena is destroyed, since every food's
+// control block holds a reference to the arena. Not thread-safe.
+class FoodArena {
+private:
+    std::pmr::monotonic_buffer_resource resource;
+
+public:
+    // initialSize sizes the first block; later blocks grow geometrically
+    explicit FoodArena(size_t initialSize);
+
+    FoodArena(const FoodArena&) = delete;
+    FoodArena& operator=(const FoodArena&) = delete;
+
+    std::pmr::memory_resource* getResource();
+
+    // allocate_shared into the arena; the food's strings use it as well
+    template <typename T, typename... Args>
+    static std::shared_ptr<T> make(const std::shared_ptr<FoodArena>& arena, Args&&... args);
+};
+
+// Allocator handed to std::allocate_shared so the object and its control
+// block come from the arena, and the arena outlives them
+template <typename T>
+class FoodArenaAllocator {
+private:
+    template <typename U> friend class FoodArenaAllocator;
+    std::shared_ptr<FoodArena> arena;
+
+public:
+    using value_type = T;
+
+    explicit FoodArenaAllocator(std::shared_ptr<FoodArena> arena) : arena(std::move(arena)) {}
+
+    template <typename U>
+    FoodArenaAllocator(const FoodArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena->getResource()->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        arena->getResource()->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const FoodArenaAllocator<U>& other) const { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!=(const FoodArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> FoodArena::make(const std::shared_ptr<FoodArena>& arena, Args&&... args) {
+    return std::allocate_shared<T>(FoodArenaAllocator<T>(arena), std::forward<Args>(args)...,
+                                   arena->getResource());
+}
+
+} // namespace diet
+
+#endif // FOOD_ARENA_H
@@ -1,278 +1,924 @@
 #include "FoodDatabase.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+#include "ParallelFor.h"
+#include "AtomicFileWriter.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <unordered_set>
+#include <future>
+#include <thread>
 
 namespace diet {
 
+namespace {
+
+// The numeric helpers below mirror std::stod/std::stoi on the fast path and
+// defer to them on anything unusual, so accepted input and the exceptions
+// thrown for bad input stay exactly the same.
+std::string_view skipLeadingSpace(std::string_view text) {
+    size_t i = 0;
+    while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+    return text.substr(i);
+}
+
+double parseDouble(std::string_view text) {
+    std::string_view digits = skipLeadingSpace(text);
+    bool plus = !digits.empty() && digits[0] == '+';
+    if (plus) digits.remove_prefix(1);
+
+    double value = 0.0;
+    auto result = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    bool hexPrefix = result.ptr != digits.data() + digits.size() && (*result.ptr == 'x' || *result.ptr == 'X');
+    if (result.ec != std::errc() || hexPrefix || (plus && digits[0] == '-')) {
+        return std::stod(std::string(text));
+    }
+    return value;
+}
+
+int parseInt(std::string_view text) {
+    std::string_view digits = skipLeadingSpace(text);
+    bool plus = !digits.empty() && digits[0] == '+';
+    if (plus) digits.remove_prefix(1);
+
+    int value = 0;
+    auto result = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (result.ec != std::errc() || (plus && digits[0] == '-')) {
+        return std::stoi(std::string(text));
+    }
+    return value;
+}
+
+// Same trim set as the getline-based parsers
+std::string_view trimView(std::string_view text) {
+    const char* ws = " \t\r\n";
+    size_t first = text.find_first_not_of(ws);
+    if (first == std::string_view::npos) return {};
+    size_t last = text.find_last_not_of(ws);
+    return text.substr(first, last - first + 1);
+}
+
+
+// One line-aligned slice of the basic foods file and what parsing it found.
+// Line numbers are relative to the start of the slice.
+struct ParsedBasic {
+    std::string_view id, name, keywords, vitamins, minerals;
+    NutrientVector nutrients;
+};
+
+struct BasicChunk {
+    std::string_view text;
+    std::vector<ParsedBasic> rows;
+    std::vector<FoodDatabase::LoadDiagnostic> diagnostics;
+    int lineCount;
+    int maxIdNumber;
+};
+
+// A composite row split into fields, with each component's servings
+// already parsed; linking happens once the basic foods exist
+struct ParsedComponent {
+    std::string text;   // the raw "foodId:servings" item
+    std::string foodId; // trimmed
+    double servings;
+    bool parsed;
+    std::string error;  // why servings failed to parse
+};
+
+struct ParsedComposite {
+    int lineNumber;
+    std::string id, name, keywords;
+    bool hasIdNumber;
+    int idNumber;
+    bool invalidId; // c_ followed by something stoi rejects
+    std::vector<ParsedComponent> components;
+};
+
+struct CompositeFile {
+    bool opened = false;
+    std::vector<ParsedComposite> rows;
+};
+
+// Splits text into at most parts pieces, each ending just after a newline
+// (or at the end of text), so no line straddles two pieces. Small inputs
+// stay whole.
+std::vector<std::string_view> splitLines(std::string_view text, unsigned parts) {
+    const size_t minChunk = 256 * 1024;
+    size_t count = std::max<size_t>(1, std::min<size_t>(parts, text.size() / minChunk));
+    std::vector<std::string_view> pieces;
+    size_t begin = 0;
+    for (size_t i = 1; i <= count && begin < text.size(); ++i) {
+        size_t end = text.size();
+        if (i < count) {
+            size_t newline = text.find('\n', std::max(begin, text.size() * i / count));
+            end = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        pieces.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return pieces;
+}
+
+void parseBasicChunk(BasicChunk& chunk) {
+    std::string_view remaining = chunk.text;
+    int lineNumber = 0;
+    while (!remaining.empty()) {
+        size_t newline = remaining.find('\n');
+        std::string_view line = remaining.substr(0, newline);
+        remaining.remove_prefix(newline == std::string_view::npos ? remaining.size() : newline + 1);
+        lineNumber++;
+
+        if (line.empty() || line[0] == '#') continue;
+
+        // Ten ';'-terminated fields followed by a non-empty remainder, which is
+        // exactly what the old getline chain accepted
+        std::string_view fields[11];
+        std::string_view rest = line;
+        int fieldCount = 0;
+        while (fieldCount < 10) {
+            size_t semi = rest.find(';');
+            if (semi == std::string_view::npos) break;
+            fields[fieldCount++] = rest.substr(0, semi);
+            rest.remove_prefix(semi + 1);
+        }
+        if (fieldCount < 10 || rest.empty()) {
+            int missing = fieldCount + (rest.empty() ? 1 : 2);
+            chunk.diagnostics.push_back({lineNumber, "Missing field " + std::to_string(missing), true});
+            continue;
+        }
+        fields[10] = rest;
+        std::string_view id = fields[0];
+
+        // Check every numeric field so one pass reports all of a line's problems
+        bool valid = true;
+        NutrientVector nutrients;
+        for (size_t i = 0; i < NutrientVector::COUNT; ++i) {
+            try {
+                nutrients[i] = parseDouble(fields[3 + i]);
+            } catch (const std::exception&) {
+                chunk.diagnostics.push_back({lineNumber, "Invalid number in field " + std::to_string(i + 4) +
+                                                         " → " + std::string(fields[3 + i]), true});
+                valid = false;
+            }
+        }
+
+        // Track max ID for auto-ID generation
+        if (id.substr(0, 2) == "b_") {
+            try {
+                chunk.maxIdNumber = std::max(chunk.maxIdNumber, parseInt(id.substr(2)));
+            } catch (const std::exception&) {
+                chunk.diagnostics.push_back({lineNumber, "Invalid ID number → " + std::string(id), false});
+                valid = false;
+            }
+        }
+        if (!valid) continue;
+
+        chunk.rows.push_back({id, fields[1], fields[2], fields[9], fields[10], nutrients});
+    }
+    chunk.lineCount = lineNumber;
+}
+
+bool readCompositeFile(const std::string& path, std::vector<ParsedComposite>& rows) {
+    std::ifstream inComp(path);
+    if (!inComp) {
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(inComp, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::stringstream ss(line);
+        ParsedComposite parsed{lineNumber, {}, {}, {}, false, 0, false, {}};
+        std::string compStr;
+
+        std::getline(ss, parsed.id, ';');
+        std::getline(ss, parsed.name, ';');
+        std::getline(ss, parsed.keywords, ';');
+        std::getline(ss, compStr);
+
+        if (parsed.id.rfind("c_", 0) == 0) {
+            try {
+                parsed.idNumber = std::stoi(parsed.id.substr(2));
+                parsed.hasIdNumber = true;
+            } catch (const std::exception&) {
+                parsed.invalidId = true;
+            }
+        }
+
+        // Parse components (format: "foodId:servings,foodId:servings,...")
+        std::stringstream cs(compStr);
+        std::string comp;
+        while (std::getline(cs, comp, ',')) {
+            if (comp.empty()) continue;
+            auto pos = comp.find(':');
+            if (pos != std::string::npos) {
+                ParsedComponent component{comp, comp.substr(0, pos), 0.0, false, {}};
+                // Trim whitespace
+                std::string& fid = component.foodId;
+                fid.erase(0, fid.find_first_not_of(" \t\r\n"));
+                fid.erase(fid.find_last_not_of(" \t\r\n") + 1);
+
+                try {
+                    component.servings = std::stod(comp.substr(pos + 1));
+                    component.parsed = true;
+                } catch (const std::exception& e) {
+                    component.error = e.what();
+                }
+                parsed.components.push_back(std::move(component));
+            }
+        }
+        rows.push_back(std::move(parsed));
+    }
+    return true;
+}
+
+// Orders composites so each one comes after every composite it contains.
+// targets holds, from starts[i] to starts[i + 1], the composite index each
+// component of composite i refers to (-1 for anything else). Rows and
+// components are visited depth-first in file order; a component leading
+// back to a composite still being visited would close a cycle, so it is
+// flagged in cyclic and not followed. Linear in composites plus components.
+std::vector<uint32_t> orderComposites(const std::vector<uint32_t>& starts, const std::vector<int32_t>& targets,
+                                      std::vector<char>& cyclic) {
+    enum : char { UNVISITED, VISITING, DONE };
+    size_t count = starts.size() - 1;
+    std::vector<char> state(count, UNVISITED);
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    cyclic.assign(targets.size(), 0);
+
+    // (composite, next component position) for each composite on the path
+    std::vector<std::pair<uint32_t, uint32_t>> path;
+    for (uint32_t root = 0; root < count; ++root) {
+        if (state[root] != UNVISITED) continue;
+        state[root] = VISITING;
+        path.emplace_back(root, starts[root]);
+
+        while (!path.empty()) {
+            uint32_t node = path.back().first;
+            uint32_t next = path.back().second;
+            if (next == starts[node + 1]) {
+                state[node] = DONE;
+                order.push_back(node);
+                path.pop_back();
+                continue;
+            }
+            path.back().second++;
+
+            int32_t target = targets[next];
+            if (target < 0) continue;
+            if (state[target] == VISITING) {
+                cyclic[next] = 1;
+            } else if (state[target] == UNVISITED) {
+                state[target] = VISITING;
+                path.emplace_back(static_cast<uint32_t>(target), starts[target]);
+            }
+        }
+    }
+    return order;
+}
+
+} // namespace
+
 // DatabaseException implementation
 FoodDatabase::DatabaseException::DatabaseException(const std::string& message)
     : std::runtime_error(message) {}
 
 // Constructor
 FoodDatabase::FoodDatabase(const std::string& basicFile, const std::string& compositeFile)
-    : basicFoodsFile(basicFile), compositeFoodsFile(compositeFile) {}
+    : basicFoodsFile(basicFile), compositeFoodsFile(compositeFile),
+      nutrientColumns(std::make_shared<NutrientColumns>()),
+      loadThreads(std::max(1u, std::thread::hardware_concurrency())) {}
 
 // Helper method to parse keywords
-std::vector<std::string> FoodDatabase::parseKeywords(const std::string& keywordStr) const {
-    std::vector<std::string> keywords;
-    std::stringstream ks(keywordStr);
-    std::string kw;
-    while (std::getline(ks, kw, ',')) {
-        // Trim whitespace
-        kw.erase(0, kw.find_first_not_of(" \t\r\n"));
-        kw.erase(kw.find_last_not_of(" \t\r\n") + 1);
+void FoodDatabase::parseKeywords(std::string_view keywordStr, std::vector<std::string_view>& keywords) const {
+    keywords.clear();
+    while (!keywordStr.empty()) {
+        size_t comma = keywordStr.find(',');
+        std::string_view kw = trimView(keywordStr.substr(0, comma));
         if (!kw.empty()) {
             keywords.push_back(kw);
         }
+        if (comma == std::string_view::npos) break;
+        keywordStr.remove_prefix(comma + 1);
     }
-    return keywords;
 }
 
-std::shared_ptr<Food> FoodDatabase::findFoodById(const std::string& id) const {
-    // Check basic foods first
-    for (const auto& food : basicFoods) {
-        if (food->getId() == id) {
-            return food;
-        }
-    }
-    
-    // Then check composite foods
-    for (const auto& food : compositeFoods) {
-        if (food->getId() == id) {
-            return food;
+void FoodDatabase::indexFood(const std::shared_ptr<Food>& food, bool composite) {
+    // Called right after the food is appended to its collection. The first
+    // food registered under an ID wins, matching the old scan order
+    uint32_t slot = static_cast<uint32_t>((composite ? compositeFoods : basicFoods).size() - 1);
+    foodIndex.emplace(food->getId(), IndexedFood{food, slot});
+    searchIndex.insert(food, composite);
+}
+
+void FoodDatabase::linkComponent(const std::shared_ptr<Food>& composite, const Food* component) {
+    auto& users = usedBy[component];
+    auto& links = uses[composite.get()];
+    links.push_back(ComponentLink{component, static_cast<uint32_t>(users.size())});
+    users.push_back(UserLink{composite, static_cast<uint32_t>(links.size() - 1)});
+}
+
+void FoodDatabase::linkDependents(const std::shared_ptr<Food>& composite) {
+    // Only called for CompositeFoods; a component listed twice is one edge
+    auto comp = std::static_pointer_cast<CompositeFood>(composite);
+    for (const auto& component : comp->getComponents()) {
+        auto users = usedBy.find(component.first.get());
+        if (users == usedBy.end() || users->second.back().user != composite) {
+            linkComponent(composite, component.first.get());
         }
     }
-    
-    return nullptr; // Not found
 }
 
-std::vector<std::shared_ptr<Food>> FoodDatabase::findFoodsByKeyword(const std::string& keyword) const {
-    std::vector<std::shared_ptr<Food>> results;
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
-    
-    // Lambda to check if a food's keywords contain our search term
-    auto hasKeyword = [&lowerKeyword](const std::shared_ptr<Food>& food) {
-        const auto& keywords = food->getKeywords();
-        for (const auto& kw : keywords) {
-            std::string lowerKw = kw;
-            std::transform(lowerKw.begin(), lowerKw.end(), lowerKw.begin(), ::tolower);
-            if (lowerKw.find(lowerKeyword) != std::string::npos) {
-                return true;
-            }
+void FoodDatabase::unlinkDependents(const std::shared_ptr<Food>& composite) {
+    auto links = uses.find(composite.get());
+    if (links == uses.end()) return;
+    for (const auto& link : links->second) {
+        auto users = usedBy.find(link.component);
+        auto& list = users->second;
+
+        // Move the last user into the freed slot and repoint its back link
+        if (link.slot + 1 != list.size()) {
+            list[link.slot] = std::move(list.back());
+            const UserLink& moved = list[link.slot];
+            uses.find(moved.user.get())->second[moved.back].slot = link.slot;
         }
-        // Also check the name
-        std::string lowerName = food->getName();
-        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-        return lowerName.find(lowerKeyword) != std::string::npos;
-    };
-    
-    // Search in basic foods
-    for (const auto& food : basicFoods) {
-        if (hasKeyword(food)) {
-            results.push_back(food);
+        list.pop_back();
+        if (list.empty()) {
+            usedBy.erase(users);
         }
     }
-    
-    // Search in composite foods
-    for (const auto& food : compositeFoods) {
-        if (hasKeyword(food)) {
-            results.push_back(food);
-        }
+    uses.erase(links);
+}
+
+void FoodDatabase::adoptNutrients(const std::shared_ptr<Food>& food) {
+    // Only called once the food is known to be a BasicFood
+    auto basic = std::static_pointer_cast<BasicFood>(food);
+    uint32_t row = nutrientColumns->append(basic->getNutrients());
+    basic->rebindNutrients(nutrientColumns, row);
+    rowFoods.push_back(food);
+}
+
+void FoodDatabase::reportIssue(std::vector<LoadDiagnostic>& sink, const std::string& file,
+                               int lineNumber, const std::string& message, bool formatError) {
+    std::cerr << "❌ Line " << lineNumber << " of " << file << ": " << message << "\n";
+    sink.push_back({lineNumber, message, formatError});
+}
+
+std::shared_ptr<Food> FoodDatabase::findFoodById(std::string_view id) const {
+    auto it = foodIndex.find(id);
+    if (it != foodIndex.end()) {
+        return it->second.food;
     }
-    
+    return nullptr; // Not found
+}
+
+const Food* FoodDatabase::findFoodHandle(std::string_view id) const {
+    auto it = foodIndex.find(id);
+    return it != foodIndex.end() ? it->second.food.get() : nullptr;
+}
+
+std::vector<std::shared_ptr<Food>> FoodDatabase::findFoodsByKeyword(std::string_view keyword) const {
+    std::vector<std::shared_ptr<Food>> results;
+    searchIndex.find(keyword, results);
     return results;
 }
 
+void FoodDatabase::findFoodsByKeyword(std::string_view keyword,
+                                      std::vector<std::shared_ptr<Food>>& results) const {
+    searchIndex.find(keyword, results);
+}
+
 void FoodDatabase::loadDatabase() {
     // Clear existing data
     basicFoods.clear();
     compositeFoods.clear();
+    foodIndex.clear();
+    searchIndex.clear();
+    usedBy.clear();
+    uses.clear();
+    nutrientColumns = std::make_shared<NutrientColumns>();
+    rowFoods.clear();
     
-    // Load basic foods
-    std::ifstream inBasic(basicFoodsFile);
-    if (!inBasic) {
+    basicDiagnostics.clear();
+    compositeDiagnostics.clear();
+    basicFileLoaded = false;
+    compositeFileLoaded = false;
+    basicDirty = true;
+    compositeDirty = true;
+
+    // The composite file only needs the basic foods once its rows are
+    // linked, so it is read and split alongside the basic file
+    auto compositeRead = std::async(loadThreads > 1 ? std::launch::async : std::launch::deferred,
+                                    [this] {
+        CompositeFile file;
+        file.opened = readCompositeFile(compositeFoodsFile, file.rows);
+        return file;
+    });
+    
+    // Load basic foods straight out of a mapped view of the file
+    MappedFile basicFile;
+    if (!basicFile.open(basicFoodsFile)) {
         std::cerr << "Failed to open basic foods file: " << basicFoodsFile << std::endl;
         return;
     }
+    basicFileLoaded = true;
 
-    std::string line;
-    while (std::getline(inBasic, line)) {
-        if (line.empty() || line[0] == '#') continue;
-    
-        std::stringstream ss(line);
-        std::string id, name, keywordStr, calStr, proteinStr, carbStr, fatStr, satFatStr, fiberStr, vitaminStr, mineralStr;
-    
-        // Attempt to extract all fields
-        if (!std::getline(ss, id, ';') || !std::getline(ss, name, ';') || !std::getline(ss, keywordStr, ';') ||
-            !std::getline(ss, calStr, ';') || !std::getline(ss, proteinStr, ';') || !std::getline(ss, carbStr, ';') ||
-            !std::getline(ss, fatStr, ';') || !std::getline(ss, satFatStr, ';') || !std::getline(ss, fiberStr, ';') ||
-            !std::getline(ss, vitaminStr, ';') || !std::getline(ss, mineralStr)) {
-            std::cerr << "❌ Skipping malformed line (not enough fields):\n  " << line << "\n";
-            continue;
+    // Parse line-aligned chunks in parallel; diagnostics carry chunk-local
+    // line numbers until the chunks are joined in file order
+    std::vector<BasicChunk> chunks;
+    for (std::string_view text : splitLines(basicFile.view(), loadThreads)) {
+        chunks.push_back(BasicChunk{text, {}, {}, 0, 0});
+    }
+    parallelFor(chunks.size(), loadThreads, [&](size_t c) { parseBasicChunk(chunks[c]); });
+
+    // Foods take roughly as much space as their text, so the file size is a
+    // fair first block
+    arena = std::make_shared<FoodArena>(basicFile.view().size());
+
+    size_t rowCount = 0;
+    for (const auto& chunk : chunks) {
+        rowCount += chunk.rows.size();
+    }
+    basicFoods.reserve(rowCount);
+    rowFoods.reserve(rowCount);
+    nutrientColumns->reserve(rowCount);
+    foodIndex.reserve(rowCount);
+
+    std::vector<std::string_view> keywords; // reused across rows
+    int lineOffset = 0;
+    for (const auto& chunk : chunks) {
+        for (const auto& diagnostic : chunk.diagnostics) {
+            reportIssue(basicDiagnostics, basicFoodsFile, lineOffset + diagnostic.lineNumber, diagnostic.message,
+                        diagnostic.formatError);
         }
-    
-        try {
-            // Parse keywords
-            auto keywords = parseKeywords(keywordStr);
-    
-            // Track max ID for auto-ID generation
-            if (id.rfind("b_", 0) == 0) {
-                int num = std::stoi(id.substr(2));
-                basicIdCounter = std::max(basicIdCounter, num);
-            }
-    
-            // Convert all numeric fields safely
-            double calories = std::stod(calStr);
-            double protein = std::stod(proteinStr);
-            double carbs = std::stod(carbStr);
-            double fat = std::stod(fatStr);
-            double satFat = std::stod(satFatStr);
-            double fiber = std::stod(fiberStr);
-    
-            auto food = std::make_shared<BasicFood>(
-                id, name, keywords,
-                calories, protein, carbs, fat, satFat, fiber,
-                vitaminStr, mineralStr
-            );
-    
+        basicIdCounter = std::max(basicIdCounter, chunk.maxIdNumber);
+
+        for (const auto& parsed : chunk.rows) {
+            uint32_t row = nutrientColumns->append(parsed.nutrients);
+            parseKeywords(parsed.keywords, keywords);
+            auto food = FoodArena::make<BasicFood>(
+                arena, parsed.id, parsed.name, keywords, nutrientColumns, row, parsed.vitamins, parsed.minerals);
+
+            foodIndex.emplace(food->getId(), IndexedFood{food, static_cast<uint32_t>(basicFoods.size())});
             basicFoods.push_back(food);
-    
-        } catch (const std::invalid_argument& e) {
-            std::cerr << "❌ Invalid numeric value in line:\n  " << line << "\n  → " << e.what() << "\n";
-        } catch (const std::exception& e) {
-            std::cerr << "❌ Failed to load line:\n  " << line << "\n  → " << e.what() << "\n";
+            rowFoods.push_back(food);
         }
+        lineOffset += chunk.lineCount;
     }
-    
-    inBasic.close();
+    searchIndex.insertAll(basicFoods, false, loadThreads);
+    basicDirty = false;
 
     // Load composite foods
-    std::ifstream inComp(compositeFoodsFile);
-    if (!inComp) {
+    CompositeFile compositeFile = compositeRead.get();
+    if (!compositeFile.opened) {
         std::cerr << "Failed to open composite foods file: " << compositeFoodsFile << std::endl;
         return;
     }
+    compositeFileLoaded = true;
 
-    while (std::getline(inComp, line)) {
-        if (line.empty() || line[0] == '#') continue;
-        
-        std::stringstream ss(line);
-        std::string id, name, keywordStr, compStr;
+    // Create and register every composite first, so components may refer
+    // to composites further down the file
+    compositeFoods.reserve(compositeFile.rows.size());
+    for (const auto& parsed : compositeFile.rows) {
+        if (parsed.invalidId) continue;
+        if (parsed.hasIdNumber) {
+            compositeIdCounter = std::max(compositeIdCounter, parsed.idNumber);
+        }
 
-        std::getline(ss, id, ';');
-        std::getline(ss, name, ';');
-        std::getline(ss, keywordStr, ';');
-        std::getline(ss, compStr);
+        parseKeywords(parsed.keywords, keywords);
+        auto compFood = FoodArena::make<CompositeFood>(arena, parsed.id, parsed.name, keywords);
+        compositeFoods.push_back(compFood);
+        indexFood(compFood, true);
+    }
 
-        auto keywords = parseKeywords(keywordStr);
+    std::unordered_map<const Food*, int32_t> compositeRows;
+    compositeRows.reserve(compositeFoods.size());
+    for (size_t i = 0; i < compositeFoods.size(); ++i) {
+        compositeRows.emplace(compositeFoods[i].get(), static_cast<int32_t>(i));
+    }
 
-        if (id.rfind("c_", 0) == 0) {
-            int num = std::stoi(id.substr(2));
-            compositeIdCounter = std::max(compositeIdCounter, num);
+    // Resolve every component once; composite targets become graph edges
+    std::vector<uint32_t> starts{0};
+    std::vector<std::shared_ptr<Food>> resolved;
+    std::vector<int32_t> targets;
+    starts.reserve(compositeFoods.size() + 1);
+    for (const auto& parsed : compositeFile.rows) {
+        if (parsed.invalidId) continue;
+        for (const auto& comp : parsed.components) {
+            std::shared_ptr<Food> component = comp.parsed ? findFoodById(comp.foodId) : nullptr;
+            auto row = component ? compositeRows.find(component.get()) : compositeRows.end();
+            targets.push_back(row != compositeRows.end() ? row->second : -1);
+            resolved.push_back(std::move(component));
         }
+        starts.push_back(static_cast<uint32_t>(targets.size()));
+    }
+    std::vector<char> cyclic;
+    std::vector<uint32_t> order = orderComposites(starts, targets, cyclic);
 
-        auto compFood = std::make_shared<CompositeFood>(id, name, keywords);
-        
-        // Parse components (format: "foodId:servings,foodId:servings,...")
-        std::stringstream cs(compStr);
-        std::string comp;
-        while (std::getline(cs, comp, ',')) {
-            if (comp.empty()) continue;
-            auto pos = comp.find(':');
-            if (pos != std::string::npos) {
-                std::string fid = comp.substr(0, pos);
-                // Trim whitespace
-                fid.erase(0, fid.find_first_not_of(" \t\r\n"));
-                fid.erase(fid.find_last_not_of(" \t\r\n") + 1);
-                
-                try {
-                    double servings = std::stod(comp.substr(pos + 1));
-                    auto component = findFoodById(fid);
-                    if (component) {
-                        compFood->addComponent(component, servings);
-                    } else {
-                        std::cerr << "Component food with ID " << fid
-                                << " not found for composite food " << id << std::endl;
-                    }
-                } catch (const std::exception& e) {
-                    std::cerr << "Error parsing component servings: " << comp << " - " << e.what() << std::endl;
+    // Link in file order so diagnostics keep their usual order
+    size_t i = 0;
+    for (const auto& parsed : compositeFile.rows) {
+        if (parsed.invalidId) {
+            reportIssue(compositeDiagnostics, compositeFoodsFile, parsed.lineNumber,
+                        "Invalid ID number → " + parsed.id);
+            continue;
+        }
+        auto compFood = std::static_pointer_cast<CompositeFood>(compositeFoods[i]);
+        for (size_t k = 0; k < parsed.components.size(); ++k) {
+            const auto& comp = parsed.components[k];
+            size_t edge = starts[i] + k;
+            try {
+                if (!comp.parsed) {
+                    throw std::invalid_argument(comp.error);
                 }
+                if (!resolved[edge]) {
+                    reportIssue(compositeDiagnostics, compositeFoodsFile, parsed.lineNumber,
+                                "Component food with ID " + comp.foodId + " not found for composite food " + parsed.id);
+                } else if (cyclic[edge]) {
+                    reportIssue(compositeDiagnostics, compositeFoodsFile, parsed.lineNumber,
+                                "Component food with ID " + comp.foodId + " would make composite food " +
+                                parsed.id + " contain itself");
+                } else {
+                    compFood->addComponent(resolved[edge], comp.servings);
+                }
+            } catch (const std::exception& e) {
+                reportIssue(compositeDiagnostics, compositeFoodsFile, parsed.lineNumber,
+                            "Error parsing component servings: " + comp.text + " - " + e.what());
             }
         }
-        compositeFoods.push_back(compFood);
+        linkDependents(compFood);
+        ++i;
     }
-    inComp.close();
+
+    // Flatten children before their parents, so each composite's totals are
+    // computed once from already flattened components
+    for (uint32_t i : order) {
+        compositeFoods[i]->getNutrients();
+    }
+    compositeDirty = false;
 }
 
 void FoodDatabase::saveDatabase() const {
-    // Save basic foods
-    std::ofstream outBasic(basicFoodsFile);
-    if (!outBasic) {
-        throw DatabaseException("Failed to open file for writing: " + basicFoodsFile);
+    try {
+        // Files that still match what was loaded are left alone
+        if (basicDirty) {
+            AtomicFileWriter outBasic(basicFoodsFile);
+            outBasic << "# Format: id;name;keywords;calories;protein;carbs;fat;saturatedFat;fiber;vitamins;minerals\n";
+
+            for (const auto& food : basicFoods) {
+                auto basic = foodAs<BasicFood>(food.get());
+                if (basic) {
+                    outBasic << basic->getId() << ';' << basic->getName() << ';';
+
+                    // Write keywords as comma-separated list
+                    size_t keywordCount = basic->getKeywordCount();
+                    for (size_t i = 0; i < keywordCount; ++i) {
+                        outBasic << basic->getKeyword(i);
+                        if (i < keywordCount - 1) outBasic << ',';
+                    }
+
+                    outBasic << ';' << basic->getCalories()
+                             << ';' << basic->getProtein()
+                             << ';' << basic->getCarbs()
+                             << ';' << basic->getFat()
+                             << ';' << basic->getSaturatedFat()
+                             << ';' << basic->getFiber()
+                             << ';' << basic->getVitamins()
+                             << ';' << basic->getMinerals() << '\n';
+                }
+            }
+            outBasic.commit();
+            basicDirty = false;
+        }
+
+        if (compositeDirty) {
+            AtomicFileWriter outComp(compositeFoodsFile);
+            outComp << "# Format: id;name;keywords;components\n";
+            outComp << "# Components format: foodId:servings,foodId:servings,...\n";
+
+            for (const auto& food : compositeFoods) {
+                auto comp = foodAs<CompositeFood>(food.get());
+                if (comp) {
+                    outComp << comp->getId() << ';' << comp->getName() << ';';
+
+                    // Write keywords
+                    size_t keywordCount = comp->getKeywordCount();
+                    for (size_t i = 0; i < keywordCount; ++i) {
+                        outComp << comp->getKeyword(i);
+                        if (i < keywordCount - 1) outComp << ',';
+                    }
+
+                    outComp << ';';
+
+                    // Write components
+                    const auto& components = comp->getComponents();
+                    for (size_t i = 0; i < components.size(); ++i) {
+                        outComp << components[i].first->getId() << ':' << components[i].second;
+                        if (i < components.size() - 1) outComp << ',';
+                    }
+                    outComp << '\n';
+                }
+            }
+            outComp.commit();
+            compositeDirty = false;
+        }
+    } catch (const AtomicFileWriter::WriteException& e) {
+        throw DatabaseException(e.what());
     }
-    
-    outBasic << "# Format: id;name;keywords;calories;protein;carbs;fat;saturatedFat;fiber;vitamins;minerals\n";
-    
+}
+
+void FoodDatabase::saveSnapshot(const std::string& path) const {
+    SnapshotWriter writer;
+    writer.basicIdCounter = basicIdCounter;
+    writer.compositeIdCounter = compositeIdCounter;
+
+    // Components are stored as positions: basic foods first, then composites
+    std::unordered_map<const Food*, uint32_t> position;
+    for (size_t i = 0; i < basicFoods.size(); ++i) {
+        position.emplace(basicFoods[i].get(), static_cast<uint32_t>(i));
+    }
+    for (size_t i = 0; i < compositeFoods.size(); ++i) {
+        position.emplace(compositeFoods[i].get(), static_cast<uint32_t>(basicFoods.size() + i));
+    }
+
     for (const auto& food : basicFoods) {
-        auto basic = std::dynamic_pointer_cast<BasicFood>(food);
-        if (basic) {
-            outBasic << basic->getId() << ";" << basic->getName() << ";";
-
-            // Write keywords as comma-separated list
-            const auto& keywords = basic->getKeywords();
-            for (size_t i = 0; i < keywords.size(); ++i) {
-                outBasic << keywords[i];
-                if (i < keywords.size() - 1) outBasic << ",";
+        auto basic = static_cast<const BasicFood*>(food.get());
+        writer.basicIds.push_back(writer.addString(basic->getId()));
+        writer.basicNames.push_back(writer.addString(basic->getName()));
+        for (size_t k = 0; k < basic->getKeywordCount(); ++k) {
+            writer.keywordRefs.push_back(writer.addString(basic->getKeyword(k)));
+        }
+        writer.basicKeywordStarts.push_back(static_cast<uint32_t>(writer.keywordRefs.size()));
+        const auto& nutrients = basic->getNutrients();
+        for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+            writer.basicNutrients[n].push_back(nutrients[n]);
+        }
+        writer.basicVitamins.push_back(writer.addString(basic->getVitamins()));
+        writer.basicMinerals.push_back(writer.addString(basic->getMinerals()));
+    }
+
+    // Composite keyword ranges continue where the basic ones stopped
+    writer.compositeKeywordStarts.front() = static_cast<uint32_t>(writer.keywordRefs.size());
+    for (const auto& food : compositeFoods) {
+        auto comp = static_cast<const CompositeFood*>(food.get());
+        writer.compositeIds.push_back(writer.addString(comp->getId()));
+        writer.compositeNames.push_back(writer.addString(comp->getName()));
+        for (size_t k = 0; k < comp->getKeywordCount(); ++k) {
+            writer.keywordRefs.push_back(writer.addString(comp->getKeyword(k)));
+        }
+        writer.compositeKeywordStarts.push_back(static_cast<uint32_t>(writer.keywordRefs.size()));
+        for (const auto& component : comp->getComponents()) {
+            auto it = position.find(component.first.get());
+            if (it == position.end()) {
+                throw DatabaseException("Component " + std::string(component.first->getId()) + " of " +
+                                        std::string(comp->getId()) + " is not in the database");
             }
+            writer.componentFoods.push_back(it->second);
+            writer.componentServings.push_back(component.second);
+        }
+        writer.componentStarts.push_back(static_cast<uint32_t>(writer.componentFoods.size()));
+    }
 
-            outBasic << ";" << basic->getCalories()
-                     << ";" << basic->getProtein()
-                     << ";" << basic->getCarbs()
-                     << ";" << basic->getFat()
-                     << ";" << basic->getSaturatedFat()
-                     << ";" << basic->getFiber()
-                     << ";" << basic->getVitamins()
-                     << ";" << basic->getMinerals() << "\n";
+    // The search index goes in as built, so loading skips the gram work
+    SearchIndex::Image image;
+    searchIndex.saveImage(image);
+    for (size_t i = 0; i < image.foods.size(); ++i) {
+        auto it = position.find(image.foods[i].get());
+        if (it == position.end()) {
+            throw DatabaseException("Indexed food " + std::string(image.foods[i]->getId()) + " is not in the database");
+        }
+        writer.searchFoods.push_back(it->second);
+        writer.searchNames.push_back(writer.addString(image.names[i]));
+        for (uint32_t k = image.keywordStarts[i]; k < image.keywordStarts[i + 1]; ++k) {
+            writer.searchKeywordRefs.push_back(writer.addString(image.keywords[k]));
         }
+        writer.searchKeywordStarts.push_back(static_cast<uint32_t>(writer.searchKeywordRefs.size()));
     }
-    outBasic.close();
+    writer.grams = std::move(image.grams);
+    writer.postingStarts = std::move(image.postingStarts);
+    writer.postings = std::move(image.postings);
 
-    // Save composite foods
-    std::ofstream outComp(compositeFoodsFile);
-    if (!outComp) {
-        throw DatabaseException("Failed to open file for writing: " + compositeFoodsFile);
+    try {
+        writer.write(path);
+    } catch (const SnapshotException& e) {
+        throw DatabaseException(e.what());
     }
-    
-    outComp << "# Format: id;name;keywords;components\n";
-    outComp << "# Components format: foodId:servings,foodId:servings,...\n";
-    
-    for (const auto& food : compositeFoods) {
-        auto comp = std::dynamic_pointer_cast<CompositeFood>(food);
-        if (comp) {
-            outComp << comp->getId() << ";" << comp->getName() << ";";
-
-            // Write keywords
-            const auto& keywords = comp->getKeywords();
-            for (size_t i = 0; i < keywords.size(); ++i) {
-                outComp << keywords[i];
-                if (i < keywords.size() - 1) outComp << ",";
+}
+
+bool FoodDatabase::loadSnapshot(const std::string& path) {
+    SnapshotReader reader;
+    std::shared_ptr<FoodArena> loadedArena;
+    auto loadedColumns = std::make_shared<NutrientColumns>();
+    std::vector<std::shared_ptr<Food>> loadedBasics;
+    std::vector<std::shared_ptr<Food>> loadedComposites;
+    std::vector<uint32_t> order;
+    SearchIndex::Image image; // views into reader
+
+    try {
+        if (!reader.open(path)) {
+            return false;
+        }
+        const auto& header = reader.getHeader();
+        loadedArena = std::make_shared<FoodArena>(
+            (header.basicCount + header.compositeCount) * (sizeof(BasicFood) + 64));
+
+        auto keywordRefs = reader.keywordRefs();
+        auto keywordsBetween = [&](uint32_t begin, uint32_t end) {
+            if (begin > end || end > keywordRefs.size) {
+                throw DatabaseException("Snapshot keyword ranges are corrupt: " + path);
+            }
+            std::vector<std::string_view> keywords;
+            keywords.reserve(end - begin);
+            for (uint32_t k = begin; k < end; ++k) {
+                keywords.push_back(reader.getString(keywordRefs[k]));
+            }
+            return keywords;
+        };
+
+        // Basic foods come straight out of the nutrient columns
+        auto ids = reader.basicIds();
+        auto names = reader.basicNames();
+        auto vitamins = reader.basicVitamins();
+        auto minerals = reader.basicMinerals();
+        auto keywordStarts = reader.basicKeywordStarts();
+        SnapshotReader::Column<double> nutrients[NutrientVector::COUNT];
+        for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+            nutrients[n] = reader.basicNutrient(static_cast<NutrientVector::Index>(n));
+        }
+
+        loadedBasics.reserve(header.basicCount);
+        loadedColumns->reserve(header.basicCount);
+        for (uint32_t i = 0; i < header.basicCount; ++i) {
+            NutrientVector values;
+            for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+                values[n] = nutrients[n][i];
+            }
+            uint32_t row = loadedColumns->append(values);
+            loadedBasics.push_back(FoodArena::make<BasicFood>(
+                loadedArena, reader.getString(ids[i]), reader.getString(names[i]),
+                keywordsBetween(keywordStarts[i], keywordStarts[i + 1]), loadedColumns, row,
+                reader.getString(vitamins[i]), reader.getString(minerals[i])
+            ));
+        }
+
+        // Create every composite before wiring components, so component
+        // indices may point at any composite in the snapshot
+        auto compIds = reader.compositeIds();
+        auto compNames = reader.compositeNames();
+        auto compKeywordStarts = reader.compositeKeywordStarts();
+        std::vector<std::shared_ptr<CompositeFood>> composites;
+        composites.reserve(header.compositeCount);
+        for (uint32_t i = 0; i < header.compositeCount; ++i) {
+            composites.push_back(FoodArena::make<CompositeFood>(
+                loadedArena, reader.getString(compIds[i]), reader.getString(compNames[i]),
+                keywordsBetween(compKeywordStarts[i], compKeywordStarts[i + 1])
+            ));
+        }
+
+        // Check the component graph the way loadDatabase does before wiring
+        // anything; a saved database never has a cycle, so one means the
+        // file is corrupt
+        auto componentStarts = reader.componentStarts();
+        auto componentFoods = reader.componentFoods();
+        auto componentServings = reader.componentServings();
+        std::vector<uint32_t> starts{0};
+        std::vector<int32_t> targets;
+        starts.reserve(header.compositeCount + 1);
+        for (uint32_t i = 0; i < header.compositeCount; ++i) {
+            uint32_t begin = componentStarts[i];
+            uint32_t end = componentStarts[i + 1];
+            if (begin != starts.back() || end < begin || end > componentFoods.size) {
+                throw DatabaseException("Snapshot component ranges are corrupt: " + path);
+            }
+            for (uint32_t c = begin; c < end; ++c) {
+                uint32_t target = componentFoods[c];
+                if (target >= header.basicCount + header.compositeCount) {
+                    throw DatabaseException("Snapshot component index is corrupt: " + path);
+                }
+                targets.push_back(target < header.basicCount ? -1 : static_cast<int32_t>(target - header.basicCount));
             }
+            starts.push_back(end);
+        }
+        std::vector<char> cyclic;
+        order = orderComposites(starts, targets, cyclic);
+        if (std::find(cyclic.begin(), cyclic.end(), 1) != cyclic.end()) {
+            throw DatabaseException("Snapshot components form a cycle: " + path);
+        }
+
+        for (uint32_t i = 0; i < header.compositeCount; ++i) {
+            for (uint32_t c = starts[i]; c < starts[i + 1]; ++c) {
+                uint32_t target = componentFoods[c];
+                std::shared_ptr<Food> component = target < header.basicCount
+                    ? loadedBasics[target]
+                    : std::static_pointer_cast<Food>(composites[target - header.basicCount]);
+                composites[i]->addComponent(component, componentServings[c]);
+            }
+        }
+        loadedComposites.assign(composites.begin(), composites.end());
 
-            outComp << ";";
-            
-            // Write components
-            const auto& components = comp->getComponents();
-            for (size_t i = 0; i < components.size(); ++i) {
-                outComp << components[i].first->getId() << ":" << components[i].second;
-                if (i < components.size() - 1) outComp << ",";
+        // The saved search index must cover every food once, with ascending
+        // grams and ascending slots, or searches would go wrong
+        uint32_t foodCount = header.basicCount + header.compositeCount;
+        auto searchFoods = reader.searchFoods();
+        auto searchNames = reader.searchNames();
+        auto searchKeywordStarts = reader.searchKeywordStarts();
+        auto searchKeywordRefs = reader.searchKeywordRefs();
+        auto grams = reader.grams();
+        auto postingStarts = reader.postingStarts();
+        auto postings = reader.postings();
+        auto corrupt = [&] { return DatabaseException("Snapshot search index is corrupt: " + path); };
+        if (header.searchCount != foodCount) {
+            throw corrupt();
+        }
+        std::vector<char> indexed(foodCount, 0);
+        image.foods.reserve(foodCount);
+        image.names.reserve(foodCount);
+        image.keywords.reserve(searchKeywordRefs.size);
+        for (uint32_t i = 0; i < header.searchCount; ++i) {
+            uint32_t food = searchFoods[i];
+            uint32_t begin = searchKeywordStarts[i];
+            uint32_t end = searchKeywordStarts[i + 1];
+            if (food >= foodCount || indexed[food] || begin != image.keywords.size() || end < begin ||
+                end > searchKeywordRefs.size) {
+                throw corrupt();
+            }
+            indexed[food] = 1;
+            image.foods.push_back(food < header.basicCount ? loadedBasics[food] : loadedComposites[food - header.basicCount]);
+            image.names.push_back(reader.getString(searchNames[i]));
+            for (uint32_t k = begin; k < end; ++k) {
+                image.keywords.push_back(reader.getString(searchKeywordRefs[k]));
+            }
+            image.keywordStarts.push_back(end);
+        }
+        for (uint32_t g = 0; g < header.gramCount; ++g) {
+            uint32_t begin = postingStarts[g];
+            uint32_t end = postingStarts[g + 1];
+            if ((g > 0 && grams[g] <= grams[g - 1]) || begin != image.postingStarts.back() || end <= begin ||
+                end > postings.size) {
+                throw corrupt();
+            }
+            for (uint32_t p = begin; p < end; ++p) {
+                if (postings[p] >= header.searchCount || (p > begin && postings[p] <= postings[p - 1])) {
+                    throw corrupt();
+                }
             }
-            outComp << "\n";
+            image.postingStarts.push_back(end);
+        }
+        if (image.postingStarts.back() != postings.size) {
+            throw corrupt();
         }
+        image.grams.assign(grams.data, grams.data + grams.size);
+        image.postings.assign(postings.data, postings.data + postings.size);
+
+        // Only replace the current contents once the whole snapshot is valid
+        basicIdCounter = header.basicIdCounter;
+        compositeIdCounter = header.compositeIdCounter;
+    } catch (const SnapshotException& e) {
+        throw DatabaseException(e.what());
+    } catch (const std::invalid_argument& e) {
+        throw DatabaseException("Snapshot has an invalid component: " + std::string(e.what()));
+    }
+
+    arena = std::move(loadedArena);
+    nutrientColumns = std::move(loadedColumns);
+    rowFoods = loadedBasics;
+    basicFoods = std::move(loadedBasics);
+    compositeFoods = std::move(loadedComposites);
+    foodIndex.clear();
+    usedBy.clear();
+    uses.clear();
+    searchIndex.loadImage(image);
+
+    foodIndex.reserve(basicFoods.size() + compositeFoods.size());
+    for (size_t i = 0; i < basicFoods.size(); ++i) {
+        foodIndex.emplace(basicFoods[i]->getId(), IndexedFood{basicFoods[i], static_cast<uint32_t>(i)});
+    }
+    for (size_t i = 0; i < compositeFoods.size(); ++i) {
+        foodIndex.emplace(compositeFoods[i]->getId(), IndexedFood{compositeFoods[i], static_cast<uint32_t>(i)});
+        linkDependents(compositeFoods[i]);
     }
-    outComp.close();
+
+    // Children before parents, as after a text load
+    for (uint32_t i : order) {
+        compositeFoods[i]->getNutrients();
+    }
+
+    basicDiagnostics.clear();
+    compositeDiagnostics.clear();
+    basicFileLoaded = true;
+    compositeFileLoaded = true;
+
+    // The text files may be older than the snapshot
+    basicDirty = true;
+    compositeDirty = true;
+    return true;
 }
 
 void FoodDatabase::addBasicFood(const std::shared_ptr<Food>& food) {
@@ -281,16 +927,19 @@ void FoodDatabase::addBasicFood(const std::shared_ptr<Food>& food) {
     }
     
     // Verify it's actually a BasicFood
-    if (!std::dynamic_pointer_cast<BasicFood>(food)) {
+    if (food->getKind() != Food::Kind::BASIC) {
         throw DatabaseException("Food is not a BasicFood instance");
     }
     
     // Check for ID conflicts
     if (findFoodById(food->getId())) {
-        throw DatabaseException("A food with ID " + food->getId() + " already exists");
+        throw DatabaseException("A food with ID " + std::string(food->getId()) + " already exists");
     }
     
     basicFoods.push_back(food);
+    adoptNutrients(food);
+    indexFood(food, false);
+    basicDirty = true;
 }
 
 void FoodDatabase::addCompositeFood(const std::shared_ptr<Food>& food) {
@@ -299,48 +948,222 @@ void FoodDatabase::addCompositeFood(const std::shared_ptr<Food>& food) {
     }
     
     // Verify it's actually a CompositeFood
-    if (!std::dynamic_pointer_cast<CompositeFood>(food)) {
+    if (food->getKind() != Food::Kind::COMPOSITE) {
         throw DatabaseException("Food is not a CompositeFood instance");
     }
     
     // Check for ID conflicts
     if (findFoodById(food->getId())) {
-        throw DatabaseException("A food with ID " + food->getId() + " already exists");
+        throw DatabaseException("A food with ID " + std::string(food->getId()) + " already exists");
     }
     
     compositeFoods.push_back(food);
+    indexFood(food, true);
+    linkDependents(food);
+    compositeDirty = true;
 }
 
-bool FoodDatabase::removeFood(const std::string& id) {
-    // First check if this food is used as a component in any composite food
-    for (const auto& food : compositeFoods) {
-        auto comp = std::dynamic_pointer_cast<CompositeFood>(food);
-        if (comp) {
-            for (const auto& component : comp->getComponents()) {
-                if (component.first->getId() == id) {
-                    throw DatabaseException("Cannot remove food " + id + " because it is used in " + comp->getId());
+void FoodDatabase::validateBatch(const std::vector<std::shared_ptr<Food>>& foods, bool composite) const {
+    std::unordered_set<std::string_view> batchIds;
+    batchIds.reserve(foods.size());
+
+    for (const auto& food : foods) {
+        if (!food) {
+            throw DatabaseException("Cannot add null food");
+        }
+        if (food->getKind() != (composite ? Food::Kind::COMPOSITE : Food::Kind::BASIC)) {
+            throw DatabaseException(composite ? "Food is not a CompositeFood instance"
+                                              : "Food is not a BasicFood instance");
+        }
+
+        std::string_view id = food->getId();
+        if (foodIndex.count(id)) {
+            throw DatabaseException("A food with ID " + std::string(id) + " already exists");
+        }
+        if (!batchIds.insert(id).second) {
+            throw DatabaseException("Food ID " + std::string(id) + " appears more than once in the batch");
+        }
+    }
+}
+
+void FoodDatabase::trackIdCounter(std::string_view id, std::string_view prefix, int& counter) {
+    if (id.substr(0, prefix.size()) != prefix) {
+        return;
+    }
+    int num = 0;
+    const char* digits = id.data() + prefix.size();
+    auto result = std::from_chars(digits, id.data() + id.size(), num);
+    if (result.ec == std::errc()) {
+        counter = std::max(counter, num);
+    }
+}
+
+void FoodDatabase::addBasicFoods(const std::vector<std::shared_ptr<Food>>& foods) {
+    // Everything is checked before anything is inserted
+    validateBatch(foods, false);
+
+    basicFoods.reserve(basicFoods.size() + foods.size());
+    foodIndex.reserve(foodIndex.size() + foods.size());
+    nutrientColumns->reserve(nutrientColumns->size() + foods.size());
+    for (const auto& food : foods) {
+        basicFoods.push_back(food);
+        adoptNutrients(food);
+        indexFood(food, false);
+        trackIdCounter(food->getId(), "b_", basicIdCounter);
+    }
+    if (!foods.empty()) {
+        basicDirty = true;
+    }
+}
+
+void FoodDatabase::addCompositeFoods(const std::vector<std::shared_ptr<Food>>& foods) {
+    // Everything is checked before anything is inserted
+    validateBatch(foods, true);
+
+    compositeFoods.reserve(compositeFoods.size() + foods.size());
+    foodIndex.reserve(foodIndex.size() + foods.size());
+    for (const auto& food : foods) {
+        compositeFoods.push_back(food);
+        indexFood(food, true);
+        linkDependents(food);
+        trackIdCounter(food->getId(), "c_", compositeIdCounter);
+    }
+    if (!foods.empty()) {
+        compositeDirty = true;
+    }
+}
+
+void FoodDatabase::addComponent(std::string_view compositeId, std::string_view componentId, double servings) {
+    auto composite = findFoodById(compositeId);
+    auto comp = foodAs<CompositeFood>(composite.get());
+    if (!comp) {
+        throw DatabaseException("Composite food not found with ID: " + std::string(compositeId));
+    }
+    auto component = findFoodById(componentId);
+    if (!component) {
+        throw DatabaseException("Food not found with ID: " + std::string(componentId));
+    }
+
+    // The composites containing this one are exactly those whose caches go
+    // stale, and none of them (nor the composite itself) may become a
+    // component of it
+    auto dependents = findDependentFoods(compositeId);
+    if (component == composite || std::find(dependents.begin(), dependents.end(), component) != dependents.end()) {
+        throw DatabaseException("Component food with ID " + std::string(componentId) +
+                                " would make composite food " + std::string(compositeId) + " contain itself");
+    }
+
+    try {
+        comp->addComponent(component, servings);
+    } catch (const std::invalid_argument& e) {
+        throw DatabaseException(e.what());
+    }
+
+    // The composite's own links say whether it already used the component
+    auto& links = uses[composite.get()];
+    if (std::none_of(links.begin(), links.end(),
+                     [&](const ComponentLink& link) { return link.component == component.get(); })) {
+        linkComponent(composite, component.get());
+    }
+    for (const auto& dependent : dependents) {
+        static_cast<CompositeFood*>(dependent.get())->invalidateCache();
+    }
+    compositeDirty = true;
+}
+
+bool FoodDatabase::removeFood(std::string_view id) {
+    auto indexed = foodIndex.find(id);
+    if (indexed == foodIndex.end()) {
+        return false; // Not found
+    }
+    auto target = indexed->second.food;
+    uint32_t slot = indexed->second.slot;
+
+    // A food still used as a component has to stay
+    auto users = usedBy.find(target.get());
+    if (users != usedBy.end()) {
+        throw DatabaseException("Cannot remove food " + std::string(id) +
+                                " because it is used in " + std::string(users->second.front().user->getId()));
+    }
+
+    foodIndex.erase(indexed);
+    searchIndex.erase(target);
+
+    // The row itself stays until the next load; scans just skip it
+    auto basic = foodAs<BasicFood>(target.get());
+    if (basic && basic->columns == nutrientColumns) {
+        rowFoods[basic->row].reset();
+    }
+
+    // Swap-remove the indexed instance from whichever collection owns it.
+    // The moved food's slot is fixed up if it is the one its ID indexes
+    auto& owner = basic ? basicFoods : compositeFoods;
+    if (slot + 1 != owner.size()) {
+        owner[slot] = std::move(owner.back());
+        auto moved = foodIndex.find(owner[slot]->getId());
+        if (moved != foodIndex.end() && moved->second.food == owner[slot]) {
+            moved->second.slot = slot;
+        }
+    }
+    owner.pop_back();
+    if (basic) {
+        basicDirty = true;
+    } else {
+        unlinkDependents(target);
+        compositeDirty = true;
+    }
+    return true;
+}
+
+std::vector<std::shared_ptr<Food>> FoodDatabase::findDependentFoods(std::string_view id) const {
+    std::vector<std::shared_ptr<Food>> dependents;
+    auto food = findFoodById(id);
+    if (!food) {
+        return dependents;
+    }
+
+    // Breadth-first over the used-by edges, so direct users come first
+    std::unordered_set<const Food*> seen;
+    const Food* current = food.get();
+    size_t next = 0;
+    while (current) {
+        auto users = usedBy.find(current);
+        if (users != usedBy.end()) {
+            for (const auto& link : users->second) {
+                if (seen.insert(link.user.get()).second) {
+                    dependents.push_back(link.user);
                 }
             }
         }
+        current = next < dependents.size() ? dependents[next++].get() : nullptr;
     }
-    
-    // Now try to remove from basic foods
-    for (auto it = basicFoods.begin(); it != basicFoods.end(); ++it) {
-        if ((*it)->getId() == id) {
-            basicFoods.erase(it);
-            return true;
+    return dependents;
+}
+
+std::vector<std::shared_ptr<Food>> FoodDatabase::findBasicFoodsByNutrient(NutrientVector::Index nutrient,
+                                                                           double min, double max) const {
+    std::vector<std::shared_ptr<Food>> results;
+    const double* values = nutrientColumns->column(nutrient);
+    size_t rows = nutrientColumns->size();
+    for (size_t row = 0; row < rows; ++row) {
+        if (values[row] >= min && values[row] <= max && rowFoods[row]) {
+            results.push_back(rowFoods[row]);
         }
     }
-    
-    // Then try composite foods
-    for (auto it = compositeFoods.begin(); it != compositeFoods.end(); ++it) {
-        if ((*it)->getId() == id) {
-            compositeFoods.erase(it);
-            return true;
-        }
+    return results;
+}
+
+const NutrientColumns& FoodDatabase::getNutrientColumns() const {
+    return *nutrientColumns;
+}
+
+bool FoodDatabase::findNutrientRow(const Food& food, uint32_t& row) const {
+    auto basic = foodAs<BasicFood>(&food);
+    if (!basic || basic->columns != nutrientColumns) {
+        return false;
     }
-    
-    return false; // Not found
+    row = basic->row;
+    return true;
 }
 
 const std::vector<std::shared_ptr<Food>>& FoodDatabase::getBasicFoods() const {
@@ -351,6 +1174,26 @@ const std::vector<std::shared_ptr<Food>>& FoodDatabase::getCompositeFoods() cons
     return compositeFoods;
 }
 
+void FoodDatabase::setLoadThreads(unsigned threads) {
+    loadThreads = std::max(1u, threads);
+}
+
+const std::vector<FoodDatabase::LoadDiagnostic>& FoodDatabase::getBasicDiagnostics() const {
+    return basicDiagnostics;
+}
+
+const std::vector<FoodDatabase::LoadDiagnostic>& FoodDatabase::getCompositeDiagnostics() const {
+    return compositeDiagnostics;
+}
+
+bool FoodDatabase::isBasicFileLoaded() const {
+    return basicFileLoaded;
+}
+
+bool FoodDatabase::isCompositeFileLoaded() const {
+    return compositeFileLoaded;
+}
+
 std::string FoodDatabase::generateBasicFoodId() {
     return "b_" + std::to_string(++basicIdCounter);
 }
@@ -359,4 +1202,22 @@ std::string FoodDatabase::generateCompositeFoodId() {
     return "c_" + std::to_string(++compositeIdCounter);
 }
 
+std::vector<std::string> FoodDatabase::generateBasicFoodIds(size_t count) {
+    std::vector<std::string> ids;
+    ids.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ids.push_back(generateBasicFoodId());
+    }
+    return ids;
+}
+
+std::vector<std::string> FoodDatabase::generateCompositeFoodIds(size_t count) {
+    std::vector<std::string> ids;
+    ids.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ids.push_back(generateCompositeFoodId());
+    }
+    return ids;
+}
+
 } // namespace diet
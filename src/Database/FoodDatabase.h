@@ -4,14 +4,28 @@
 #include "../Food/Food.h"
 #include "../Food/BasicFood.h"
 #include "../Food/CompositeFood.h"
+#include "SearchIndex.h"
+#include "FoodArena.h"
 #include <vector>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace diet {
 
 class FoodDatabase {
+public:
+    // Problem found while loading a data file, tied to its 1-based line.
+    // formatError marks a missing field or malformed nutrient value, which
+    // the CLI refuses to start with; anything else only skips the row.
+    struct LoadDiagnostic {
+        int lineNumber;
+        std::string message;
+        bool formatError;
+    };
+
 private:
     std::vector<std::shared_ptr<Food>> basicFoods;
     std::vector<std::shared_ptr<Food>> compositeFoods;
@@ -21,9 +35,77 @@ private:
     // Track the last used ID number for basic & composite foods
     int basicIdCounter = 0;
     int compositeIdCounter = 0;
+
+    // ID -> food index over both collections, kept in sync by load/add/remove.
+    // Keys view the ID of the food they map to; slot is the food's position
+    // in basicFoods or compositeFoods.
+    struct IndexedFood {
+        std::shared_ptr<Food> food;
+        uint32_t slot;
+    };
+    std::unordered_map<std::string_view, IndexedFood> foodIndex;
+
+    // N-gram index answering keyword/name substring searches
+    SearchIndex searchIndex;
+
+    // Food -> composites listing it as a direct component, each composite
+    // once, and composite -> its entries in those lists. Each side records
+    // the other's position, so unlinking a composite swap-removes its
+    // entries without searching. Users are in the order the composites were
+    // added until a removal moves the last one into the gap. Kept in sync
+    // by load/add/remove.
+    struct UserLink {
+        std::shared_ptr<Food> user;
+        uint32_t back; // index into uses[user]
+    };
+    struct ComponentLink {
+        const Food* component;
+        uint32_t slot; // index into usedBy[component]
+    };
+    std::unordered_map<const Food*, std::vector<UserLink>> usedBy;
+    std::unordered_map<const Food*, std::vector<ComponentLink>> uses;
     
-    // Helper methods for parsing
-    std::vector<std::string> parseKeywords(const std::string& keywordStr) const;
+    // Nutrients of every basic food, one row each (see NutrientColumns).
+    // rowFoods maps a row back to its food; removed foods leave a null row
+    // until the next load.
+    std::shared_ptr<NutrientColumns> nutrientColumns;
+    std::vector<std::shared_ptr<Food>> rowFoods;
+
+    // Arena holding the foods of the last load; replaced on every load, and
+    // released once none of its foods are referenced any more
+    std::shared_ptr<FoodArena> arena;
+
+    // Helper methods for parsing; fills keywords with views into keywordStr
+    void parseKeywords(std::string_view keywordStr, std::vector<std::string_view>& keywords) const;
+
+    // Worker threads loadDatabase may use
+    unsigned loadThreads;
+
+    // Outcome of the last loadDatabase call
+    std::vector<LoadDiagnostic> basicDiagnostics;
+    std::vector<LoadDiagnostic> compositeDiagnostics;
+    bool basicFileLoaded = false;
+    bool compositeFileLoaded = false;
+
+    // Whether each text file differs from memory; saveDatabase only
+    // rewrites the files that do
+    mutable bool basicDirty = true;
+    mutable bool compositeDirty = true;
+
+    // Prints a line-numbered diagnostic and records it in sink
+    static void reportIssue(std::vector<LoadDiagnostic>& sink, const std::string& file,
+                            int lineNumber, const std::string& message, bool formatError = false);
+
+    // Helpers for bulk insertion
+    void validateBatch(const std::vector<std::shared_ptr<Food>>& foods, bool composite) const;
+    static void trackIdCounter(std::string_view id, std::string_view prefix, int& counter);
+
+    // Helper methods for index maintenance
+    void indexFood(const std::shared_ptr<Food>& food, bool composite);
+    void adoptNutrients(const std::shared_ptr<Food>& food);
+    void linkComponent(const std::shared_ptr<Food>& composite, const Food* component);
+    void linkDependents(const std::shared_ptr<Food>& composite);
+    void unlinkDependents(const std::shared_ptr<Food>& composite);
 
 public:
     // Exception class for database errors
@@ -35,24 +117,97 @@ public:
     // Constructor
     FoodDatabase(const std::string& basicFile, const std::string& compositeFile);
 
-    // File operations
+    // File operations. loadDatabase parses large basic files in parallel
+    // chunks and reads the composite file alongside; foods, diagnostics and
+    // their order are the same as a single-threaded load. Components may
+    // name composites anywhere in the file; one that would make a composite
+    // contain itself is reported and left out.
     void loadDatabase();
+
+    // Rewrites only the files changed since they were loaded or last saved.
+    // Each file is written to a temporary file and renamed into place.
     void saveDatabase() const;
 
+    // Defaults to the hardware concurrency; 1 loads on the calling thread
+    void setLoadThreads(unsigned threads);
+
+    // Results of the last load: whether each file could be read, and the
+    // rows it rejected or could only partially resolve
+    const std::vector<LoadDiagnostic>& getBasicDiagnostics() const;
+    const std::vector<LoadDiagnostic>& getCompositeDiagnostics() const;
+    bool isBasicFileLoaded() const;
+    bool isCompositeFileLoaded() const;
+
+    // Binary snapshot (see Snapshot.h); the text files remain the
+    // import/export format. loadSnapshot returns false if path does not exist
+    // and leaves the database untouched if the snapshot is invalid. It skips
+    // text parsing and takes the search index as saved, so no grams are
+    // computed; creating the foods and the ID index is still linear in the
+    // number of foods (diet_bench compares it with a text load).
+    void saveSnapshot(const std::string& path) const;
+    bool loadSnapshot(const std::string& path);
+
     // Food management
     void addBasicFood(const std::shared_ptr<Food>& food);
     void addCompositeFood(const std::shared_ptr<Food>& food);
-    bool removeFood(const std::string& id);
+
+    // Bulk versions: the whole batch is validated (null, type, ID conflicts
+    // against the database and within the batch) before any food is added,
+    // so a failed batch leaves the database unchanged
+    void addBasicFoods(const std::vector<std::shared_ptr<Food>>& foods);
+    void addCompositeFoods(const std::vector<std::shared_ptr<Food>>& foods);
+
+    // Adds a component to a composite already in the database. The used-by
+    // index is updated and the cached totals of the composite and of every
+    // composite containing it are invalidated; other composites keep theirs.
+    // Throws if either food is unknown, servings is not positive, or the
+    // component would make the composite contain itself.
+    void addComponent(std::string_view compositeId, std::string_view componentId, double servings);
+
+    // Throws if a composite still uses the food; returns false if no food
+    // has the ID. The used-by check and the ID and search index updates
+    // cost about the size of the food itself (the search index amortised,
+    // see SearchIndex::erase). The last food of getBasicFoods() or
+    // getCompositeFoods() moves into the removed one's place, so listing and
+    // saving order is insertion order only until the first removal.
+    bool removeFood(std::string_view id);
+
+    // Composites that would lose a component if the food were removed:
+    // those containing it directly, then those containing them, and so on.
+    // Costs about the size of the answer; empty for unknown or unused foods.
+    std::vector<std::shared_ptr<Food>> findDependentFoods(std::string_view id) const;
 
     // Food access
     const std::vector<std::shared_ptr<Food>>& getBasicFoods() const;
     const std::vector<std::shared_ptr<Food>>& getCompositeFoods() const;
-    std::shared_ptr<Food> findFoodById(const std::string& id) const;
-    std::vector<std::shared_ptr<Food>> findFoodsByKeyword(const std::string& keyword) const;
+    std::shared_ptr<Food> findFoodById(std::string_view id) const;
+
+    // Non-owning lookup for hot paths; no reference count is touched. The
+    // pointer stays valid until the food is removed or the database reloads.
+    const Food* findFoodHandle(std::string_view id) const;
+    std::vector<std::shared_ptr<Food>> findFoodsByKeyword(std::string_view keyword) const;
+
+    // Same search, filling results (cleared first) so a caller that keeps
+    // the vector around searches without allocating
+    void findFoodsByKeyword(std::string_view keyword, std::vector<std::shared_ptr<Food>>& results) const;
+
+    // Basic foods whose nutrient lies in [min, max], in insertion order.
+    // Scans the nutrient's column rather than the food objects.
+    std::vector<std::shared_ptr<Food>> findBasicFoodsByNutrient(NutrientVector::Index nutrient,
+                                                                double min, double max) const;
+    const NutrientColumns& getNutrientColumns() const;
+
+    // Row of food in getNutrientColumns(); false unless it is a basic food
+    // stored there
+    bool findNutrientRow(const Food& food, uint32_t& row) const;
 
     // ID Generation
     std::string generateBasicFoodId();
     std::string generateCompositeFoodId();
+
+    // Reserve count consecutive IDs at once, for building bulk batches
+    std::vector<std::string> generateBasicFoodIds(size_t count);
+    std::vector<std::string> generateCompositeFoodIds(size_t count);
 };
 
 } // namespace diet
@@ -0,0 +1,176 @@
+#include "LogJournal.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <charconv>
+#include <stdexcept>
+#include <iterator>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define DIET_HAVE_FSYNC 1
+#endif
+
+namespace diet {
+
+namespace {
+
+const char* const GENERATION_PREFIX = "# Base generation: ";
+
+std::string generationHeader(uint64_t generation) {
+    return GENERATION_PREFIX + std::to_string(generation) + "\n";
+}
+
+// Shortest text that reads back as exactly the same double
+std::string formatServings(double servings) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), servings);
+    return std::string(buffer, result.ptr);
+}
+
+} // namespace
+
+LogJournal::LogJournal(const std::string& path) : path(path) {}
+
+LogJournal::~LogJournal() {
+    close();
+}
+
+std::vector<JournalRecord> LogJournal::readRecords(uint64_t baseGeneration, std::ostream& diagnostics) const {
+    std::vector<JournalRecord> records;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return records;
+    }
+
+    // Only lines that end in a newline were fully written
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    content.resize(content.rfind('\n') + 1);
+    std::istringstream lines(content);
+    std::string line;
+
+    if (!std::getline(lines, line) || line + "\n" != generationHeader(baseGeneration)) {
+        // Written against another base file, so it is either already folded
+        // in or unusable
+        return records;
+    }
+
+    while (std::getline(lines, line)) {
+        if (line.empty()) continue;
+
+        std::stringstream ss(line);
+        std::string type, first, second, third;
+        std::getline(ss, type, ';');
+        try {
+            Date date;
+            if (type == "+" && std::getline(ss, first, ';') && std::getline(ss, second, ';') &&
+                std::getline(ss, third) && Date::parse(first, date)) {
+                JournalRecord record{JournalRecord::Type::ADD, date, second, std::stod(third), -1};
+                records.push_back(record);
+            } else if (type == "-" && std::getline(ss, first)) {
+                JournalRecord record{JournalRecord::Type::REMOVE, Date(), "", 0.0, std::stoi(first)};
+                records.push_back(record);
+            } else {
+                diagnostics << "Skipping invalid journal record: " << line << std::endl;
+            }
+        } catch (const std::exception& e) {
+            diagnostics << "Error parsing journal record: " << line << " - " << e.what() << std::endl;
+        }
+    }
+    return records;
+}
+
+void LogJournal::open(uint64_t baseGeneration) {
+    close();
+
+    std::ifstream in(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::string header = generationHeader(baseGeneration);
+    if (content.compare(0, header.size(), header) != 0) {
+        reset(baseGeneration);
+        return;
+    }
+
+    // Drop a record torn by a crash so new appends start on a fresh line
+    size_t complete = content.rfind('\n') + 1;
+    if (complete < content.size()) {
+        std::filesystem::resize_file(path, complete);
+    }
+
+    out = std::fopen(path.c_str(), "ab");
+    if (!out) {
+        throw std::runtime_error("Failed to open log journal: " + path);
+    }
+
+    // Count the records without parsing them again; whoever read the
+    // journal has already reported any that are malformed
+    recordCount = 0;
+    for (size_t begin = header.size(); begin < complete;) {
+        size_t end = content.find('\n', begin);
+        recordCount += end > begin ? 1 : 0;
+        begin = end + 1;
+    }
+}
+
+void LogJournal::reset(uint64_t baseGeneration) {
+    close();
+    out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        throw std::runtime_error("Failed to open log journal: " + path);
+    }
+    recordCount = 0;
+    std::string header = generationHeader(baseGeneration);
+    std::fwrite(header.data(), 1, header.size(), out);
+    std::fflush(out);
+    sync();
+}
+
+void LogJournal::appendLine(const std::string& line) {
+    if (!out) {
+        throw std::runtime_error("Log journal is not open: " + path);
+    }
+    if (std::fwrite(line.data(), 1, line.size(), out) != line.size() || std::fflush(out) != 0) {
+        throw std::runtime_error("Failed to append to log journal: " + path);
+    }
+    ++recordCount;
+    if (++unsyncedCount >= SYNC_BATCH) {
+        sync();
+    }
+}
+
+void LogJournal::appendAdd(const Date& date, const std::string& foodId, double servings) {
+    appendLine("+;" + date.toString() + ";" + foodId + ";" + formatServings(servings) + "\n");
+}
+
+void LogJournal::appendRemove(int index) {
+    appendLine("-;" + std::to_string(index) + "\n");
+}
+
+void LogJournal::sync() {
+    if (!out) return;
+    std::fflush(out);
+#ifdef DIET_HAVE_FSYNC
+    fsync(fileno(out));
+#endif
+    unsyncedCount = 0;
+}
+
+void LogJournal::close() {
+    if (out) {
+        sync();
+        std::fclose(out);
+        out = nullptr;
+    }
+}
+
+bool LogJournal::isOpen() const {
+    return out != nullptr;
+}
+
+size_t LogJournal::getRecordCount() const {
+    return recordCount;
+}
+
+} // namespace diet
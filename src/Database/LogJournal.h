@@ -0,0 +1,74 @@
+#ifndef LOG_JOURNAL_H
+#define LOG_JOURNAL_H
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include "Date.h"
+
+namespace diet {
+
+// One change recorded in the journal
+struct JournalRecord {
+    enum class Type { ADD, REMOVE };
+
+    Type type;
+    Date date;
+    std::string foodId;
+    double servings = 0.0;
+    int index = -1;
+};
+
+// Append-only change journal kept next to a daily log file.
+//
+// The first line names the generation of the base file the records apply
+// to, so a journal left behind by an interrupted compaction is recognised as
+// stale instead of being replayed twice. Each record is flushed to the OS as
+// soon as it is appended; fsync is batched every SYNC_BATCH records.
+class LogJournal {
+private:
+    std::string path;
+    std::FILE* out = nullptr;
+    size_t recordCount = 0;
+    size_t unsyncedCount = 0;
+
+    void appendLine(const std::string& line);
+
+public:
+    static constexpr size_t SYNC_BATCH = 64;
+
+    explicit LogJournal(const std::string& path);
+    ~LogJournal();
+
+    LogJournal(const LogJournal&) = delete;
+    LogJournal& operator=(const LogJournal&) = delete;
+
+    // Reads the complete records written against baseGeneration. A torn
+    // final record (no trailing newline) is ignored.
+    std::vector<JournalRecord> readRecords(uint64_t baseGeneration, std::ostream& diagnostics = std::cerr) const;
+
+    // Continues the journal if it belongs to baseGeneration, otherwise
+    // starts a fresh one. Writes no diagnostics; records are counted,
+    // malformed or not, towards getRecordCount.
+    void open(uint64_t baseGeneration);
+
+    // Truncates the journal and starts it over for a new base generation
+    void reset(uint64_t baseGeneration);
+
+    void appendAdd(const Date& date, const std::string& foodId, double servings);
+    void appendRemove(int index);
+
+    // Forces buffered records to stable storage
+    void sync();
+    void close();
+
+    bool isOpen() const;
+    size_t getRecordCount() const;
+};
+
+} // namespace diet
+
+#endif // LOG_JOURNAL_H
@@ -0,0 +1,75 @@
+#include "MappedFile.h"
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DIET_HAVE_MMAP 1
+#endif
+
+namespace diet {
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+void MappedFile::release() {
+#ifdef DIET_HAVE_MMAP
+    if (mapped) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+}
+
+bool MappedFile::open(const std::string& path) {
+    release();
+
+#ifdef DIET_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* region = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (region != MAP_FAILED) {
+            madvise(region, size, MADV_SEQUENTIAL);
+            ::close(fd);
+            data = static_cast<const char*>(region);
+            mapped = true;
+            return true;
+        }
+        size = 0;
+    }
+    ::close(fd);
+#endif
+
+    // Not mappable (or no mmap on this platform): read it into memory
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+    return true;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(data ? data : "", size);
+}
+
+} // namespace diet
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace diet {
+
+// Read-only view of a whole file. Uses mmap where available and falls back
+// to reading the file into an owned buffer elsewhere.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::string buffer;
+
+    void release();
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false if the file cannot be opened or read
+    bool open(const std::string& path);
+
+    std::string_view view() const;
+};
+
+} // namespace diet
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,60 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace diet {
+
+// Runs body(index) for every index in [0, count) on up to threads threads,
+// the calling thread included, handing out indices in increasing order.
+// Returns once every call has finished; the first exception thrown by body
+// is rethrown here. With threads <= 1 it is a plain loop.
+template <typename Body>
+void parallelFor(size_t count, unsigned threads, Body body) {
+    size_t workers = std::min<size_t>(threads, count);
+    if (workers <= 1) {
+        for (size_t index = 0; index < count; ++index) {
+            body(index);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto run = [&] {
+        for (size_t index = next++; index < count; index = next++) {
+            try {
+                body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t i = 1; i < workers; ++i) {
+        pool.emplace_back(run);
+    }
+    run();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace diet
+
+#endif // PARALLEL_FOR_H
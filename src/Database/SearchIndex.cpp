@@ -0,0 +1,362 @@
+#include "SearchIndex.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace diet {
+
+std::string SearchIndex::toLower(std::string_view text) {
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lower;
+}
+
+// Packs a gram of 1-3 bytes together with its length into one key
+uint32_t SearchIndex::packGram(const char* data, size_t length) {
+    uint32_t key = static_cast<uint32_t>(length) << 24;
+    for (size_t i = 0; i < length; ++i) {
+        key |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return key;
+}
+
+void SearchIndex::appendGrams(std::string_view text, std::vector<uint32_t>& grams) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        for (size_t len = 1; len <= 3 && i + len <= text.size(); ++len) {
+            grams.push_back(packGram(text.data() + i, len));
+        }
+    }
+}
+
+const SearchIndex::KeywordInfo& SearchIndex::infoFor(Symbol keyword) {
+    auto found = keywordInfo.find(keyword);
+    if (found != keywordInfo.end()) {
+        return found->second;
+    }
+    auto& symbols = SymbolTable::global();
+    std::string lower = toLower(symbols.getText(keyword));
+    KeywordInfo info{symbols.intern(lower), {}};
+    appendGrams(lower, info.grams);
+    return keywordInfo.emplace(keyword, std::move(info)).first->second;
+}
+
+const std::vector<uint32_t>* SearchIndex::postingsFor(uint32_t gram) const {
+    auto it = postings.find(gram);
+    return it == postings.end() ? nullptr : &it->second;
+}
+
+void SearchIndex::saveImage(Image& image) const {
+    // Live slots are renumbered densely; order is kept, so lists stay sorted
+    const auto& symbols = SymbolTable::global();
+    std::vector<uint32_t> dense(entries.size(), UINT32_MAX);
+    for (size_t slot = 0; slot < entries.size(); ++slot) {
+        const Entry& entry = entries[slot];
+        if (!entry.live) {
+            continue;
+        }
+        dense[slot] = static_cast<uint32_t>(image.foods.size());
+        image.foods.push_back(entry.food);
+        image.names.push_back(entry.name);
+        for (Symbol keyword : entry.keywords) {
+            image.keywords.push_back(symbols.getText(keyword));
+        }
+        image.keywordStarts.push_back(static_cast<uint32_t>(image.keywords.size()));
+    }
+
+    // Grams in ascending order, so equal indexes give equal images
+    std::vector<uint32_t> grams;
+    grams.reserve(postings.size());
+    for (const auto& gramPostings : postings) {
+        grams.push_back(gramPostings.first);
+    }
+    std::sort(grams.begin(), grams.end());
+    for (uint32_t gram : grams) {
+        size_t before = image.postings.size();
+        for (uint32_t slot : postings.find(gram)->second) {
+            if (entries[slot].live) {
+                image.postings.push_back(dense[slot]);
+            }
+        }
+        if (image.postings.size() > before) {
+            image.grams.push_back(gram);
+            image.postingStarts.push_back(static_cast<uint32_t>(image.postings.size()));
+        }
+    }
+}
+
+void SearchIndex::loadImage(const Image& image) {
+    clear();
+    auto& symbols = SymbolTable::global();
+    entries.reserve(image.foods.size());
+    slotByFood.reserve(image.foods.size());
+    for (size_t i = 0; i < image.foods.size(); ++i) {
+        const auto& food = image.foods[i];
+        Entry entry{food, {}, std::string(image.names[i]), {}, food->getKind() == Food::Kind::COMPOSITE, true};
+        entry.keywords.reserve(image.keywordStarts[i + 1] - image.keywordStarts[i]);
+        for (uint32_t k = image.keywordStarts[i]; k < image.keywordStarts[i + 1]; ++k) {
+            entry.keywords.push_back(symbols.intern(image.keywords[k]));
+        }
+        slotByFood.emplace(food.get(), static_cast<uint32_t>(entries.size()));
+        entries.push_back(std::move(entry));
+    }
+    liveCount = entries.size();
+
+    postings.reserve(image.grams.size());
+    for (size_t g = 0; g < image.grams.size(); ++g) {
+        postings.emplace(image.grams[g], std::vector<uint32_t>(image.postings.begin() + image.postingStarts[g],
+                                                               image.postings.begin() + image.postingStarts[g + 1]));
+    }
+}
+
+void SearchIndex::clear() {
+    entries.clear();
+    slotByFood.clear();
+    postings.clear();
+    liveCount = 0;
+    deadCount = 0;
+}
+
+void SearchIndex::insert(const std::shared_ptr<Food>& food, bool composite) {
+    if (!food || slotByFood.count(food.get())) {
+        return;
+    }
+
+    uint32_t slot = static_cast<uint32_t>(entries.size());
+    Entry entry{food, {}, toLower(food->getName()), {}, composite, true};
+    for (Symbol keyword : food->getKeywordSymbols()) {
+        const auto& info = infoFor(keyword);
+        entry.keywords.push_back(info.lower);
+        entry.grams.insert(entry.grams.end(), info.grams.begin(), info.grams.end());
+    }
+    appendGrams(entry.name, entry.grams);
+    std::sort(entry.grams.begin(), entry.grams.end());
+    entry.grams.erase(std::unique(entry.grams.begin(), entry.grams.end()), entry.grams.end());
+
+    // Slots only grow, so appending keeps every posting list sorted
+    for (uint32_t gram : entry.grams) {
+        postings[gram].push_back(slot);
+    }
+
+    entries.push_back(std::move(entry));
+    slotByFood.emplace(food.get(), slot);
+    ++liveCount;
+}
+
+void SearchIndex::insertAll(const std::vector<std::shared_ptr<Food>>& foods, bool composite, unsigned threads) {
+    if (threads <= 1) {
+        for (const auto& food : foods) {
+            insert(food, composite);
+        }
+        return;
+    }
+
+    // Claim slots and resolve keyword info on this thread, since both touch
+    // shared tables
+    size_t firstSlot = entries.size();
+    for (const auto& food : foods) {
+        if (!food || slotByFood.count(food.get())) {
+            continue;
+        }
+        Entry entry{food, {}, {}, {}, composite, true};
+        for (Symbol keyword : food->getKeywordSymbols()) {
+            entry.keywords.push_back(infoFor(keyword).lower);
+        }
+        slotByFood.emplace(food.get(), static_cast<uint32_t>(entries.size()));
+        entries.push_back(std::move(entry));
+        ++liveCount;
+    }
+    size_t lastSlot = entries.size();
+
+    // Each entry's grams depend only on that entry
+    const size_t block = 1024;
+    size_t blocks = (lastSlot - firstSlot + block - 1) / block;
+    parallelFor(blocks, threads, [&](size_t b) {
+        size_t end = std::min(lastSlot, firstSlot + (b + 1) * block);
+        for (size_t slot = firstSlot + b * block; slot < end; ++slot) {
+            Entry& entry = entries[slot];
+            entry.name = toLower(entry.food->getName());
+            for (Symbol keyword : entry.food->getKeywordSymbols()) {
+                const auto& grams = keywordInfo.find(keyword)->second.grams;
+                entry.grams.insert(entry.grams.end(), grams.begin(), grams.end());
+            }
+            appendGrams(entry.name, entry.grams);
+            std::sort(entry.grams.begin(), entry.grams.end());
+            entry.grams.erase(std::unique(entry.grams.begin(), entry.grams.end()), entry.grams.end());
+        }
+    });
+
+    // Posting lists are split into shards by gram, each built privately by
+    // walking the new slots in order, then merged in on this thread. Shards
+    // never share a gram, and new slots are larger than existing ones, so
+    // every list stays sorted.
+    size_t shards = threads;
+    auto shardOf = [shards](uint32_t gram) { return (gram * 2654435761u >> 16) % shards; };
+    std::vector<std::unordered_map<uint32_t, std::vector<uint32_t>>> shardPostings(shards);
+    parallelFor(shards, threads, [&](size_t shard) {
+        auto& local = shardPostings[shard];
+        for (size_t slot = firstSlot; slot < lastSlot; ++slot) {
+            for (uint32_t gram : entries[slot].grams) {
+                if (shardOf(gram) == shard) {
+                    local[gram].push_back(static_cast<uint32_t>(slot));
+                }
+            }
+        }
+    });
+    for (auto& local : shardPostings) {
+        for (auto& gramPostings : local) {
+            auto& list = postings[gramPostings.first];
+            if (list.empty()) {
+                list = std::move(gramPostings.second);
+            } else {
+                list.insert(list.end(), gramPostings.second.begin(), gramPostings.second.end());
+            }
+        }
+    }
+}
+
+void SearchIndex::erase(const std::shared_ptr<Food>& food) {
+    auto found = slotByFood.find(food.get());
+    if (found == slotByFood.end()) {
+        return;
+    }
+
+    Entry& entry = entries[found->second];
+    entry.food.reset();
+    entry.keywords.clear();
+    entry.keywords.shrink_to_fit();
+    entry.name.clear();
+    entry.name.shrink_to_fit();
+    entry.grams.clear();
+    entry.grams.shrink_to_fit();
+    entry.live = false;
+    slotByFood.erase(found);
+    --liveCount;
+
+    if (++deadCount > liveCount / 4 + 64) {
+        purgeDead();
+    }
+}
+
+void SearchIndex::purgeDead() {
+    for (auto it = postings.begin(); it != postings.end();) {
+        auto& list = it->second;
+        list.erase(std::remove_if(list.begin(), list.end(), [this](uint32_t slot) { return !entries[slot].live; }),
+                   list.end());
+        it = list.empty() ? postings.erase(it) : std::next(it);
+    }
+    deadCount = 0;
+}
+
+void SearchIndex::collect(const std::vector<uint32_t>& slots,
+                          std::vector<std::shared_ptr<Food>>& results) const {
+    // Basic foods come before composite foods, as with the original scan.
+    // Slots of erased foods may linger until the next purge.
+    results.reserve(slots.size());
+    for (uint32_t slot : slots) {
+        if (entries[slot].live && !entries[slot].composite) {
+            results.push_back(entries[slot].food);
+        }
+    }
+    for (uint32_t slot : slots) {
+        if (entries[slot].live && entries[slot].composite) {
+            results.push_back(entries[slot].food);
+        }
+    }
+}
+
+void SearchIndex::find(std::string_view term, std::vector<std::shared_ptr<Food>>& results) const {
+    results.clear();
+
+    // Scratch space kept per thread so concurrent readers stay independent
+    thread_local std::string lowerTerm;
+    thread_local std::vector<const std::vector<uint32_t>*> lists;
+    thread_local std::vector<uint32_t> candidates;
+    thread_local std::vector<uint32_t> narrowed;
+    thread_local std::vector<uint8_t> keywordState; // by symbol: 0 unchecked, 1 miss, 2 hit
+    thread_local std::vector<Symbol> checkedKeywords;
+
+    lowerTerm.assign(term.begin(), term.end());
+    std::transform(lowerTerm.begin(), lowerTerm.end(), lowerTerm.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    // An empty term is a substring of everything
+    if (lowerTerm.empty()) {
+        results.reserve(liveCount);
+        for (bool composite : {false, true}) {
+            for (const auto& entry : entries) {
+                if (entry.live && entry.composite == composite) {
+                    results.push_back(entry.food);
+                }
+            }
+        }
+        return;
+    }
+
+    // Short terms are grams themselves, so their posting list is the answer
+    if (lowerTerm.size() <= 3) {
+        if (const auto* list = postingsFor(packGram(lowerTerm.data(), lowerTerm.size()))) {
+            collect(*list, results);
+        }
+        return;
+    }
+
+    // Gather trigram lists and intersect them, smallest first
+    lists.clear();
+    for (size_t i = 0; i + 3 <= lowerTerm.size(); ++i) {
+        const auto* list = postingsFor(packGram(lowerTerm.data() + i, 3));
+        if (!list) {
+            return;
+        }
+        lists.push_back(list);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    candidates.assign(lists.front()->begin(), lists.front()->end());
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        narrowed.clear();
+        std::set_intersection(candidates.begin(), candidates.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(narrowed));
+        candidates.swap(narrowed);
+    }
+
+    // Trigrams may come from different texts, so confirm a real substring
+    // hit. Each distinct keyword is checked once per query.
+    const auto& symbols = SymbolTable::global();
+    if (keywordState.size() < symbols.size()) {
+        keywordState.resize(symbols.size());
+    }
+    auto keywordHit = [&](Symbol keyword) {
+        if (keywordState[keyword] == 0) {
+            bool hit = symbols.getText(keyword).find(lowerTerm) != std::string_view::npos;
+            keywordState[keyword] = hit ? 2 : 1;
+            checkedKeywords.push_back(keyword);
+        }
+        return keywordState[keyword] == 2;
+    };
+
+    narrowed.clear();
+    for (uint32_t slot : candidates) {
+        const Entry& entry = entries[slot];
+        if (!entry.live) {
+            continue;
+        }
+        bool hit = std::any_of(entry.keywords.begin(), entry.keywords.end(), keywordHit) ||
+                   entry.name.find(lowerTerm) != std::string::npos;
+        if (hit) {
+            narrowed.push_back(slot);
+        }
+    }
+    for (Symbol keyword : checkedKeywords) {
+        keywordState[keyword] = 0;
+    }
+    checkedKeywords.clear();
+
+    collect(narrowed, results);
+}
+
+} // namespace diet
@@ -0,0 +1,100 @@
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include "../Food/Food.h"
+#include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <unordered_map>
+
+namespace diet {
+
+// Inverted n-gram index over lowercased food names and keywords.
+// Every 1-, 2- and 3-byte substring of each text is posted, so queries of up
+// to three characters are answered straight from a posting list and longer
+// queries intersect their trigram lists before verifying the survivors.
+// Keywords are handled per distinct symbol, so a keyword shared by many foods
+// is lowercased, split into grams and matched against a query only once.
+class SearchIndex {
+private:
+    struct Entry {
+        std::shared_ptr<Food> food;
+        std::vector<Symbol> keywords;   // lowercased keyword symbols
+        std::string name;               // lowercased name
+        std::vector<uint32_t> grams;    // distinct grams posted for this entry
+        bool composite;
+        bool live;
+    };
+
+    // Per keyword symbol: its lowercased symbol and that text's grams.
+    // Symbols are global, so this survives clear()
+    struct KeywordInfo {
+        Symbol lower;
+        std::vector<uint32_t> grams;
+    };
+    std::unordered_map<Symbol, KeywordInfo> keywordInfo;
+
+    // Entries are never reused, so slot order is insertion order
+    std::vector<Entry> entries;
+    std::unordered_map<const Food*, uint32_t> slotByFood;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings; // sorted slots
+    size_t liveCount = 0;
+
+    // Erased entries whose slots are still in the posting lists; readers
+    // skip them until purgeDead drops them all in one pass
+    size_t deadCount = 0;
+    void purgeDead();
+
+    static std::string toLower(std::string_view text);
+    static uint32_t packGram(const char* data, size_t length);
+    static void appendGrams(std::string_view text, std::vector<uint32_t>& grams);
+    const KeywordInfo& infoFor(Symbol keyword);
+    const std::vector<uint32_t>* postingsFor(uint32_t gram) const;
+    void collect(const std::vector<uint32_t>& slots, std::vector<std::shared_ptr<Food>>& results) const;
+
+public:
+    // Flat form of the index for snapshots: live entries in slot order with
+    // their lowercased texts, and each gram's posting list as positions in
+    // foods. Text views point into the index (saveImage) or the caller's
+    // storage (loadImage).
+    struct Image {
+        std::vector<std::shared_ptr<Food>> foods;
+        std::vector<std::string_view> names;
+        std::vector<uint32_t> keywordStarts{0}; // into keywords, per food plus one
+        std::vector<std::string_view> keywords;
+        std::vector<uint32_t> grams;            // ascending
+        std::vector<uint32_t> postingStarts{0}; // into postings, per gram plus one
+        std::vector<uint32_t> postings;
+    };
+
+    // The image stays valid until the index next changes
+    void saveImage(Image& image) const;
+
+    // Replaces the contents with image, which the caller has checked, in
+    // time linear in its size; no gram is recomputed
+    void loadImage(const Image& image);
+
+    void clear();
+    void insert(const std::shared_ptr<Food>& food, bool composite);
+
+    // Same result as inserting each food in order, with the per-food gram
+    // work and the posting list appends spread over up to threads threads
+    void insertAll(const std::vector<std::shared_ptr<Food>>& foods, bool composite, unsigned threads);
+
+    // Marks the food's entry dead in O(1); its posting list slots are
+    // dropped in bulk once dead entries reach a quarter of the live ones,
+    // so a removal costs amortised time proportional to its own grams
+    void erase(const std::shared_ptr<Food>& food);
+
+    // Foods whose name or any keyword contains term (case-insensitive),
+    // basic foods first, each group in insertion order. results is cleared
+    // first; its capacity and per-thread scratch space are reused, so
+    // repeated searches do not allocate once warmed up.
+    void find(std::string_view term, std::vector<std::shared_ptr<Food>>& results) const;
+};
+
+} // namespace diet
+
+#endif // SEARCH_INDEX_H
@@ -0,0 +1,285 @@
+#include "Snapshot.h"
+#include "AtomicFileWriter.h"
+#include <cstring>
+
+namespace diet {
+
+using namespace snapshot;
+
+SnapshotException::SnapshotException(const std::string& message)
+    : std::runtime_error(message) {}
+
+namespace {
+
+constexpr size_t ALIGNMENT = 8;
+
+// Appends raw bytes to out, padded so the next section stays aligned
+template <typename T>
+void appendSection(std::string& out, Header& header, Section section, const T* data, size_t count) {
+    out.resize((out.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT, '\0');
+    header.sectionOffsets[section] = out.size();
+    header.sectionSizes[section] = count * sizeof(T);
+    if (count > 0) {
+        out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+}
+
+template <typename T>
+void appendSection(std::string& out, Header& header, Section section, const std::vector<T>& data) {
+    appendSection(out, header, section, data.data(), data.size());
+}
+
+} // namespace
+
+uint32_t SnapshotWriter::addString(std::string_view text) {
+    auto inserted = stringIds.emplace(text, static_cast<uint32_t>(strings.size()));
+    if (inserted.second) {
+        strings.push_back(text);
+    }
+    return inserted.first->second;
+}
+
+void SnapshotWriter::write(const std::string& path) const {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.basicCount = static_cast<uint32_t>(basicIds.size());
+    header.compositeCount = static_cast<uint32_t>(compositeIds.size());
+    header.keywordRefCount = static_cast<uint32_t>(keywordRefs.size());
+    header.componentCount = static_cast<uint32_t>(componentFoods.size());
+    header.stringCount = static_cast<uint32_t>(strings.size());
+    header.basicIdCounter = basicIdCounter;
+    header.compositeIdCounter = compositeIdCounter;
+    header.searchCount = static_cast<uint32_t>(searchFoods.size());
+    header.searchKeywordRefCount = static_cast<uint32_t>(searchKeywordRefs.size());
+    header.gramCount = static_cast<uint32_t>(grams.size());
+    header.postingCount = static_cast<uint32_t>(postings.size());
+
+    std::vector<uint32_t> stringOffsets;
+    std::string stringData;
+    stringOffsets.reserve(strings.size() + 1);
+    for (const auto& text : strings) {
+        stringOffsets.push_back(static_cast<uint32_t>(stringData.size()));
+        stringData += text;
+    }
+    stringOffsets.push_back(static_cast<uint32_t>(stringData.size()));
+
+    std::vector<double> nutrients;
+    nutrients.reserve(NutrientVector::COUNT * basicIds.size());
+    for (const auto& columnValues : basicNutrients) {
+        nutrients.insert(nutrients.end(), columnValues.begin(), columnValues.end());
+    }
+
+    // The header is written last, once every offset is known
+    std::string out(sizeof(Header), '\0');
+    appendSection(out, header, STRING_OFFSETS, stringOffsets);
+    appendSection(out, header, STRING_DATA, stringData.data(), stringData.size());
+    appendSection(out, header, KEYWORD_REFS, keywordRefs);
+    appendSection(out, header, BASIC_IDS, basicIds);
+    appendSection(out, header, BASIC_NAMES, basicNames);
+    appendSection(out, header, BASIC_VITAMINS, basicVitamins);
+    appendSection(out, header, BASIC_MINERALS, basicMinerals);
+    appendSection(out, header, BASIC_KEYWORD_STARTS, basicKeywordStarts);
+    appendSection(out, header, BASIC_NUTRIENTS, nutrients);
+    appendSection(out, header, COMPOSITE_IDS, compositeIds);
+    appendSection(out, header, COMPOSITE_NAMES, compositeNames);
+    appendSection(out, header, COMPOSITE_KEYWORD_STARTS, compositeKeywordStarts);
+    appendSection(out, header, COMPONENT_STARTS, componentStarts);
+    appendSection(out, header, COMPONENT_FOODS, componentFoods);
+    appendSection(out, header, COMPONENT_SERVINGS, componentServings);
+    appendSection(out, header, SEARCH_FOODS, searchFoods);
+    appendSection(out, header, SEARCH_NAMES, searchNames);
+    appendSection(out, header, SEARCH_KEYWORD_STARTS, searchKeywordStarts);
+    appendSection(out, header, SEARCH_KEYWORD_REFS, searchKeywordRefs);
+    appendSection(out, header, SEARCH_GRAMS, grams);
+    appendSection(out, header, SEARCH_POSTING_STARTS, postingStarts);
+    appendSection(out, header, SEARCH_POSTINGS, postings);
+    header.fileSize = out.size();
+    std::memcpy(&out[0], &header, sizeof(Header));
+
+    // Written beside the old snapshot and renamed over it, so a failed
+    // write leaves the previous snapshot intact
+    try {
+        AtomicFileWriter outFile(path);
+        outFile << std::string_view(out);
+        outFile.commit();
+    } catch (const AtomicFileWriter::WriteException& e) {
+        throw SnapshotException(e.what());
+    }
+}
+
+template <typename T>
+SnapshotReader::Column<T> SnapshotReader::column(Section section, size_t count) const {
+    Column<T> result;
+    result.data = reinterpret_cast<const T*>(file.view().data() + header.sectionOffsets[section]);
+    result.size = count;
+    return result;
+}
+
+bool SnapshotReader::open(const std::string& path) {
+    if (!file.open(path)) {
+        return false;
+    }
+
+    std::string_view bytes = file.view();
+    if (bytes.size() < sizeof(Header)) {
+        throw SnapshotException("Snapshot file is truncated: " + path);
+    }
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw SnapshotException("Not a food database snapshot: " + path);
+    }
+    if (header.byteOrderMark != BYTE_ORDER_MARK) {
+        throw SnapshotException("Snapshot was written on a machine with a different byte order: " + path);
+    }
+    if (header.version != VERSION) {
+        throw SnapshotException("Unsupported snapshot version " + std::to_string(header.version) + ": " + path);
+    }
+    if (header.fileSize != bytes.size()) {
+        throw SnapshotException("Snapshot file size does not match its header: " + path);
+    }
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        uint64_t offset = header.sectionOffsets[i];
+        uint64_t size = header.sectionSizes[i];
+        if (offset % ALIGNMENT != 0 || offset > bytes.size() || size > bytes.size() - offset) {
+            throw SnapshotException("Snapshot section out of bounds: " + path);
+        }
+    }
+
+    // Every column must hold exactly the element count the header promises
+    auto expect = [&](Section section, uint64_t count, size_t width) {
+        if (header.sectionSizes[section] != count * width) {
+            throw SnapshotException("Snapshot section has the wrong size: " + path);
+        }
+    };
+    uint64_t basics = header.basicCount;
+    uint64_t composites = header.compositeCount;
+    expect(STRING_OFFSETS, uint64_t(header.stringCount) + 1, sizeof(uint32_t));
+    expect(KEYWORD_REFS, header.keywordRefCount, sizeof(uint32_t));
+    expect(BASIC_IDS, basics, sizeof(uint32_t));
+    expect(BASIC_NAMES, basics, sizeof(uint32_t));
+    expect(BASIC_VITAMINS, basics, sizeof(uint32_t));
+    expect(BASIC_MINERALS, basics, sizeof(uint32_t));
+    expect(BASIC_KEYWORD_STARTS, basics + 1, sizeof(uint32_t));
+    expect(BASIC_NUTRIENTS, basics * NutrientVector::COUNT, sizeof(double));
+    expect(COMPOSITE_IDS, composites, sizeof(uint32_t));
+    expect(COMPOSITE_NAMES, composites, sizeof(uint32_t));
+    expect(COMPOSITE_KEYWORD_STARTS, composites + 1, sizeof(uint32_t));
+    expect(COMPONENT_STARTS, composites + 1, sizeof(uint32_t));
+    expect(COMPONENT_FOODS, header.componentCount, sizeof(uint32_t));
+    expect(COMPONENT_SERVINGS, header.componentCount, sizeof(double));
+    expect(SEARCH_FOODS, header.searchCount, sizeof(uint32_t));
+    expect(SEARCH_NAMES, header.searchCount, sizeof(uint32_t));
+    expect(SEARCH_KEYWORD_STARTS, uint64_t(header.searchCount) + 1, sizeof(uint32_t));
+    expect(SEARCH_KEYWORD_REFS, header.searchKeywordRefCount, sizeof(uint32_t));
+    expect(SEARCH_GRAMS, header.gramCount, sizeof(uint32_t));
+    expect(SEARCH_POSTING_STARTS, uint64_t(header.gramCount) + 1, sizeof(uint32_t));
+    expect(SEARCH_POSTINGS, header.postingCount, sizeof(uint32_t));
+
+    auto offsets = column<uint32_t>(STRING_OFFSETS, header.stringCount + 1);
+    if (offsets[header.stringCount] != header.sectionSizes[STRING_DATA]) {
+        throw SnapshotException("Snapshot string table is corrupt: " + path);
+    }
+    return true;
+}
+
+std::string_view SnapshotReader::getString(uint32_t index) const {
+    if (index >= header.stringCount) {
+        throw SnapshotException("Snapshot string index out of range");
+    }
+    auto offsets = column<uint32_t>(STRING_OFFSETS, header.stringCount + 1);
+    uint32_t begin = offsets[index];
+    uint32_t end = offsets[index + 1];
+    if (begin > end || end > header.sectionSizes[STRING_DATA]) {
+        throw SnapshotException("Snapshot string table is corrupt");
+    }
+    return std::string_view(file.view().data() + header.sectionOffsets[STRING_DATA] + begin, end - begin);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::keywordRefs() const {
+    return column<uint32_t>(KEYWORD_REFS, header.keywordRefCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::basicIds() const {
+    return column<uint32_t>(BASIC_IDS, header.basicCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::basicNames() const {
+    return column<uint32_t>(BASIC_NAMES, header.basicCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::basicVitamins() const {
+    return column<uint32_t>(BASIC_VITAMINS, header.basicCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::basicMinerals() const {
+    return column<uint32_t>(BASIC_MINERALS, header.basicCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::basicKeywordStarts() const {
+    return column<uint32_t>(BASIC_KEYWORD_STARTS, header.basicCount + 1);
+}
+
+SnapshotReader::Column<double> SnapshotReader::basicNutrient(NutrientVector::Index nutrient) const {
+    Column<double> all = column<double>(BASIC_NUTRIENTS, header.basicCount * NutrientVector::COUNT);
+    all.data += static_cast<size_t>(nutrient) * header.basicCount;
+    all.size = header.basicCount;
+    return all;
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::compositeIds() const {
+    return column<uint32_t>(COMPOSITE_IDS, header.compositeCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::compositeNames() const {
+    return column<uint32_t>(COMPOSITE_NAMES, header.compositeCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::compositeKeywordStarts() const {
+    return column<uint32_t>(COMPOSITE_KEYWORD_STARTS, header.compositeCount + 1);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::componentStarts() const {
+    return column<uint32_t>(COMPONENT_STARTS, header.compositeCount + 1);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::componentFoods() const {
+    return column<uint32_t>(COMPONENT_FOODS, header.componentCount);
+}
+
+SnapshotReader::Column<double> SnapshotReader::componentServings() const {
+    return column<double>(COMPONENT_SERVINGS, header.componentCount);
+}
+
+
+SnapshotReader::Column<uint32_t> SnapshotReader::searchFoods() const {
+    return column<uint32_t>(SEARCH_FOODS, header.searchCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::searchNames() const {
+    return column<uint32_t>(SEARCH_NAMES, header.searchCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::searchKeywordStarts() const {
+    return column<uint32_t>(SEARCH_KEYWORD_STARTS, header.searchCount + 1);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::searchKeywordRefs() const {
+    return column<uint32_t>(SEARCH_KEYWORD_REFS, header.searchKeywordRefCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::grams() const {
+    return column<uint32_t>(SEARCH_GRAMS, header.gramCount);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::postingStarts() const {
+    return column<uint32_t>(SEARCH_POSTING_STARTS, header.gramCount + 1);
+}
+
+SnapshotReader::Column<uint32_t> SnapshotReader::postings() const {
+    return column<uint32_t>(SEARCH_POSTINGS, header.postingCount);
+}
+
+} // namespace diet
@@ -0,0 +1,167 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "MappedFile.h"
+#include "../Food/NutrientVector.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <stdexcept>
+
+namespace diet {
+
+// Binary snapshot of a FoodDatabase.
+//
+// Layout: a fixed header followed by 8-byte aligned sections. Strings are
+// stored once in a shared table and referenced by index. Basic food
+// nutrients are stored column by column. Composite components refer to foods
+// by global index (basic foods first, then composites), so loading needs no
+// ID lookups. The search index is stored as built, lowercased texts and
+// posting lists included, so loading it computes no grams.
+namespace snapshot {
+
+constexpr char MAGIC[8] = {'D', 'I', 'E', 'T', 'S', 'N', 'A', 'P'};
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+enum Section : size_t {
+    STRING_OFFSETS = 0,       // uint32[stringCount + 1]
+    STRING_DATA,              // char[]
+    KEYWORD_REFS,             // uint32[keywordRefCount], string indices
+    BASIC_IDS,                // uint32[basicCount], string indices
+    BASIC_NAMES,              // uint32[basicCount]
+    BASIC_VITAMINS,           // uint32[basicCount]
+    BASIC_MINERALS,           // uint32[basicCount]
+    BASIC_KEYWORD_STARTS,     // uint32[basicCount + 1], into KEYWORD_REFS
+    BASIC_NUTRIENTS,          // double[NutrientVector::COUNT * basicCount], one column per nutrient
+    COMPOSITE_IDS,            // uint32[compositeCount]
+    COMPOSITE_NAMES,          // uint32[compositeCount]
+    COMPOSITE_KEYWORD_STARTS, // uint32[compositeCount + 1], into KEYWORD_REFS
+    COMPONENT_STARTS,         // uint32[compositeCount + 1], into the component arrays
+    COMPONENT_FOODS,          // uint32[componentCount], global food indices
+    COMPONENT_SERVINGS,       // double[componentCount]
+    SEARCH_FOODS,             // uint32[searchCount], global food indices in slot order
+    SEARCH_NAMES,             // uint32[searchCount], lowercased names
+    SEARCH_KEYWORD_STARTS,    // uint32[searchCount + 1], into SEARCH_KEYWORD_REFS
+    SEARCH_KEYWORD_REFS,      // uint32[searchKeywordRefCount], lowercased keywords
+    SEARCH_GRAMS,             // uint32[gramCount], ascending
+    SEARCH_POSTING_STARTS,    // uint32[gramCount + 1], into SEARCH_POSTINGS
+    SEARCH_POSTINGS,          // uint32[postingCount], slots
+    SECTION_COUNT
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint32_t basicCount;
+    uint32_t compositeCount;
+    uint32_t keywordRefCount;
+    uint32_t componentCount;
+    uint32_t stringCount;
+    int32_t basicIdCounter;
+    int32_t compositeIdCounter;
+    uint32_t searchCount;
+    uint32_t searchKeywordRefCount;
+    uint32_t gramCount;
+    uint32_t postingCount;
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint64_t sectionOffsets[SECTION_COUNT];
+    uint64_t sectionSizes[SECTION_COUNT];
+};
+
+} // namespace snapshot
+
+// Thrown when a snapshot file is truncated, corrupt or from another version
+class SnapshotException : public std::runtime_error {
+public:
+    explicit SnapshotException(const std::string& message);
+};
+
+// Collects columns in memory and writes them out as one snapshot file
+class SnapshotWriter {
+private:
+    // Views of the caller's text, which must outlive write()
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> stringIds;
+
+public:
+    int32_t basicIdCounter = 0;
+    int32_t compositeIdCounter = 0;
+
+    std::vector<uint32_t> keywordRefs;
+    std::vector<uint32_t> basicIds, basicNames, basicVitamins, basicMinerals;
+    std::vector<uint32_t> basicKeywordStarts{0};
+    std::vector<double> basicNutrients[NutrientVector::COUNT];
+    std::vector<uint32_t> compositeIds, compositeNames;
+    std::vector<uint32_t> compositeKeywordStarts{0};
+    std::vector<uint32_t> componentStarts{0};
+    std::vector<uint32_t> componentFoods;
+    std::vector<double> componentServings;
+    std::vector<uint32_t> searchFoods, searchNames;
+    std::vector<uint32_t> searchKeywordStarts{0};
+    std::vector<uint32_t> searchKeywordRefs;
+    std::vector<uint32_t> grams;
+    std::vector<uint32_t> postingStarts{0};
+    std::vector<uint32_t> postings;
+
+    // Returns the table index of text, storing it on first use
+    uint32_t addString(std::string_view text);
+
+    void write(const std::string& path) const;
+};
+
+// Read-only, zero-copy view over a mapped snapshot file
+class SnapshotReader {
+public:
+    template <typename T>
+    struct Column {
+        const T* data = nullptr;
+        size_t size = 0;
+        const T& operator[](size_t i) const { return data[i]; }
+    };
+
+private:
+    MappedFile file;
+    snapshot::Header header{};
+
+    template <typename T>
+    Column<T> column(snapshot::Section section, size_t count) const;
+
+public:
+    // Returns false if the file does not exist; throws SnapshotException if
+    // it exists but is not a valid snapshot of this version
+    bool open(const std::string& path);
+
+    const snapshot::Header& getHeader() const { return header; }
+    std::string_view getString(uint32_t index) const;
+
+    Column<uint32_t> keywordRefs() const;
+    Column<uint32_t> basicIds() const;
+    Column<uint32_t> basicNames() const;
+    Column<uint32_t> basicVitamins() const;
+    Column<uint32_t> basicMinerals() const;
+    Column<uint32_t> basicKeywordStarts() const;
+    Column<double> basicNutrient(NutrientVector::Index nutrient) const;
+    Column<uint32_t> compositeIds() const;
+    Column<uint32_t> compositeNames() const;
+    Column<uint32_t> compositeKeywordStarts() const;
+    Column<uint32_t> componentStarts() const;
+    Column<uint32_t> componentFoods() const;
+    Column<double> componentServings() const;
+    Column<uint32_t> searchFoods() const;
+    Column<uint32_t> searchNames() const;
+    Column<uint32_t> searchKeywordStarts() const;
+    Column<uint32_t> searchKeywordRefs() const;
+    Column<uint32_t> grams() const;
+    Column<uint32_t> postingStarts() const;
+    Column<uint32_t> postings() const;
+};
+
+} // namespace diet
+
+#endif // SNAPSHOT_H
@@ -9,34 +9,52 @@ BasicFood::BasicFood(const std::string& id, const std::string& name,
                      double protein, double carbs, double fat,
                      double saturatedFat, double fiber,
                      const std::string& vitamins, const std::string& minerals)
-    : Food(id, name, keywords),
-      calories(calories),
-      protein(protein),
-      carbs(carbs),
-      fat(fat),
-      saturatedFat(saturatedFat),
-      fiber(fiber),
-      vitamins(vitamins),
-      minerals(minerals) {}
+    : Food(KIND, id, name, keywords),
+      row(0),
+      vitamins(SymbolTable::global().intern(vitamins)),
+      minerals(SymbolTable::global().intern(minerals)) {
+    auto own = std::make_shared<NutrientColumns>();
+    own->append(NutrientVector{{calories, protein, carbs, fat, saturatedFat, fiber}});
+    columns = std::move(own);
+}
+
+BasicFood::BasicFood(std::string_view id, std::string_view name,
+                     const std::vector<std::string_view>& keywords,
+                     std::shared_ptr<const NutrientColumns> columns, uint32_t row,
+                     std::string_view vitamins, std::string_view minerals,
+                     std::pmr::memory_resource* resource)
+    : Food(KIND, id, name, keywords, resource),
+      columns(std::move(columns)),
+      row(row),
+      vitamins(SymbolTable::global().intern(vitamins)),
+      minerals(SymbolTable::global().intern(minerals)) {}
+
+void BasicFood::rebindNutrients(std::shared_ptr<const NutrientColumns> columns, uint32_t row) {
+    this->columns = std::move(columns);
+    this->row = row;
+}
 
-double BasicFood::getCalories() const { return calories; }
-double BasicFood::getProtein() const { return protein; }
-double BasicFood::getCarbs() const { return carbs; }
-double BasicFood::getFat() const { return fat; }
-double BasicFood::getSaturatedFat() const { return saturatedFat; }
-double BasicFood::getFiber() const { return fiber; }
-std::string BasicFood::getVitamins() const { return vitamins; }
-std::string BasicFood::getMinerals() const { return minerals; }
+double BasicFood::getCalories() const { return columns->get(row, NutrientVector::CALORIES); }
+NutrientVector BasicFood::getNutrients() const { return columns->row(row); }
+double BasicFood::getProtein() const { return columns->get(row, NutrientVector::PROTEIN); }
+double BasicFood::getCarbs() const { return columns->get(row, NutrientVector::CARBS); }
+double BasicFood::getFat() const { return columns->get(row, NutrientVector::FAT); }
+double BasicFood::getSaturatedFat() const { return columns->get(row, NutrientVector::SATURATED_FAT); }
+double BasicFood::getFiber() const { return columns->get(row, NutrientVector::FIBER); }
+std::string_view BasicFood::getVitamins() const { return SymbolTable::global().getText(vitamins); }
+std::string_view BasicFood::getMinerals() const { return SymbolTable::global().getText(minerals); }
 
 void BasicFood::display() const {
+    NutrientVector nutrients = getNutrients();
     std::cout << "BasicFood: " << name << " (" << id << ")\n"
-              << "  Calories: " << calories << " kcal\n"
-              << "  Protein: " << std::fixed << std::setprecision(1) << protein << "g, "
-              << "Carbs: " << carbs << "g, "
-              << "Fat: " << fat << "g, "
-              << "Sat Fat: " << saturatedFat << "g, "
-              << "Fiber: " << fiber << "g\n"
-              << "  Vitamins: " << vitamins << ", Minerals: " << minerals << "\n";
+              << "  Calories: " << nutrients.calories() << " kcal\n"
+              << "  Protein: " << std::fixed << std::setprecision(1) << nutrients.protein() << "g, "
+              << "Carbs: " << nutrients.carbs() << "g, "
+              << "Fat: " << nutrients.fat() << "g, "
+              << "Sat Fat: " << nutrients.saturatedFat() << "g, "
+              << "Fiber: " << nutrients.fiber() << "g\n"
+              << "  Vitamins: " << SymbolTable::global().getText(vitamins)
+              << ", Minerals: " << SymbolTable::global().getText(minerals) << "\n";
 }
 
 } // namespace diet
@@ -2,21 +2,27 @@
 #define BASIC_FOOD_H
 
 #include "Food.h"
+#include "NutrientColumns.h"
+#include <memory>
 
 namespace diet {
 
+class FoodDatabase;
+
 class BasicFood : public Food {
 private:
-    double calories;
-    double protein;
-    double carbs;
-    double fat;
-    double saturatedFat;
-    double fiber;
-    std::string vitamins;
-    std::string minerals;
+    // Nutrients live in a shared column store; this food is one row of it.
+    // Foods built standalone get a one-row store of their own, and
+    // FoodDatabase moves them into its store when they are added.
+    std::shared_ptr<const NutrientColumns> columns;
+    uint32_t row;
+    // Whole field values, interned since most rows share a handful of them
+    Symbol vitamins;
+    Symbol minerals;
 
 public:
+    static constexpr Kind KIND = Kind::BASIC;
+
     BasicFood(const std::string& id, 
               const std::string& name,
               const std::vector<std::string>& keywords, 
@@ -29,8 +35,19 @@ public:
               const std::string& vitamins, 
               const std::string& minerals);
 
+    // Arena form, see Food
+    BasicFood(std::string_view id,
+              std::string_view name,
+              const std::vector<std::string_view>& keywords,
+              std::shared_ptr<const NutrientColumns> columns,
+              uint32_t row,
+              std::string_view vitamins,
+              std::string_view minerals,
+              std::pmr::memory_resource* resource);
+
     // Override virtual methods from base class
     double getCalories() const override;
+    NutrientVector getNutrients() const override;
     void display() const override;
     
     // Class-specific getters with const correctness
@@ -39,8 +56,13 @@ public:
     double getFat() const;
     double getSaturatedFat() const;
     double getFiber() const;
-    std::string getVitamins() const;
-    std::string getMinerals() const;
+    std::string_view getVitamins() const;
+    std::string_view getMinerals() const;
+
+private:
+    // Only valid when the new row holds the same values
+    friend class FoodDatabase;
+    void rebindNutrients(std::shared_ptr<const NutrientColumns> columns, uint32_t row);
 };
 
 } // namespace diet
@@ -1,33 +1,156 @@
 #include "CompositeFood.h"
 #include <iostream>
 #include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace diet {
 
 CompositeFood::CompositeFood(const std::string& id, const std::string& name,
                              const std::vector<std::string>& keywords)
-    : Food(id, name, keywords) {}
+    : Food(KIND, id, name, keywords) {}
+
+CompositeFood::CompositeFood(std::string_view id, std::string_view name,
+                             const std::vector<std::string_view>& keywords,
+                             std::pmr::memory_resource* resource)
+    : Food(KIND, id, name, keywords, resource) {}
+
+CompositeFood::~CompositeFood() {
+    // Detach the components of every composite about to die before it is
+    // released, so its own destructor finds nothing left to cascade into
+    std::vector<std::shared_ptr<Food>> dying;
+    auto detach = [&dying](std::vector<std::pair<std::shared_ptr<Food>, double>>& list) {
+        for (auto& comp : list) {
+            if (comp.first.use_count() == 1 && comp.first->getKind() == KIND) {
+                dying.push_back(std::move(comp.first));
+            }
+        }
+        list.clear();
+    };
+    detach(components);
+    while (!dying.empty()) {
+        std::shared_ptr<Food> food = std::move(dying.back());
+        dying.pop_back();
+        detach(static_cast<CompositeFood*>(food.get())->components);
+    }
+}
 
 void CompositeFood::addComponent(const std::shared_ptr<Food>& food, double servings) {
     if (food && servings > 0) {
         components.push_back(std::make_pair(food, servings));
+        cacheValid = false;
     } else {
         throw std::invalid_argument("Invalid food component or servings amount");
     }
 }
 
-double CompositeFood::getCalories() const {
-    double total = 0.0;
+void CompositeFood::invalidateCache() {
+    cacheValid = false;
+}
+
+void CompositeFood::flattenInto(std::vector<std::pair<const Food*, double>>& out, double scale) const {
+    for (const auto& comp : components) {
+        double servings = comp.second * scale;
+        if (auto nested = foodAs<CompositeFood>(comp.first.get())) {
+            // refreshCache has already brought the nested cache up to date
+            for (const auto& leaf : nested->flattened) {
+                out.emplace_back(leaf.first, leaf.second * servings);
+            }
+        } else {
+            out.emplace_back(comp.first.get(), servings);
+        }
+    }
+}
+
+void CompositeFood::rebuildCache() const {
+    std::vector<std::pair<const Food*, double>> leaves;
+    flattenInto(leaves, 1.0);
+
+    // Merge repeated leaves so each basic food contributes once
+    flattened.clear();
+    std::unordered_map<const Food*, size_t> position;
+    for (const auto& leaf : leaves) {
+        auto inserted = position.emplace(leaf.first, flattened.size());
+        if (inserted.second) {
+            flattened.push_back(leaf);
+        } else {
+            flattened[inserted.first->second].second += leaf.second;
+        }
+    }
+
+    cachedNutrients = NutrientVector{};
+    for (const auto& leaf : flattened) {
+        cachedNutrients.addScaled(leaf.first->getNutrients(), leaf.second);
+    }
+    cacheValid = true;
+}
+
+void CompositeFood::refreshCache() const {
+    // Usual case, e.g. during a load that goes children first: nothing
+    // below is stale
+    bool staleBelow = false;
     for (const auto& comp : components) {
-        total += comp.first->getCalories() * comp.second;
+        auto nested = foodAs<CompositeFood>(comp.first.get());
+        staleBelow = staleBelow || (nested && !nested->cacheValid);
+    }
+    if (!staleBelow) {
+        rebuildCache();
+        return;
+    }
+
+    // Collect the stale composites below this one, children before parents,
+    // with an explicit stack so a deep hierarchy cannot overflow the call
+    // stack. Composites whose cache is current are not descended into.
+    std::vector<const CompositeFood*> order;
+    std::unordered_set<const CompositeFood*> seen{this};
+    std::vector<std::pair<const CompositeFood*, size_t>> path{{this, 0}};
+    while (!path.empty()) {
+        const CompositeFood* node = path.back().first;
+        size_t next = path.back().second++;
+        if (next == node->components.size()) {
+            order.push_back(node);
+            path.pop_back();
+            continue;
+        }
+        auto nested = foodAs<CompositeFood>(node->components[next].first.get());
+        if (nested && !nested->cacheValid && seen.insert(nested).second) {
+            path.emplace_back(nested, 0);
+        }
+    }
+
+    for (const CompositeFood* comp : order) {
+        comp->rebuildCache();
     }
-    return total;
+}
+
+const std::vector<std::pair<const Food*, double>>& CompositeFood::getFlattenedComponents() const {
+    if (!cacheValid) {
+        refreshCache();
+    }
+    return flattened;
+}
+
+NutrientVector CompositeFood::getNutrients() const {
+    if (!cacheValid) {
+        refreshCache();
+    }
+    return cachedNutrients;
+}
+
+double CompositeFood::getCalories() const {
+    return getNutrients().calories();
 }
 
 void CompositeFood::display() const {
     std::cout << "CompositeFood: " << name << " (" << id << ")" << std::endl;
     std::cout << "  Total Calories: " << std::fixed << std::setprecision(1) 
               << getCalories() << " kcal" << std::endl;
+    NutrientVector totals = getNutrients();
+    std::cout << "  Protein: " << totals.protein() << "g, "
+              << "Carbs: " << totals.carbs() << "g, "
+              << "Fat: " << totals.fat() << "g, "
+              << "Sat Fat: " << totals.saturatedFat() << "g, "
+              << "Fiber: " << totals.fiber() << "g" << std::endl;
 
     if (!components.empty()) {
         std::cout << "  Components:" << std::endl;
@@ -12,19 +12,53 @@ class CompositeFood : public Food {
 private:
     // Each component is a pair: (Food pointer, servings)
     std::vector<std::pair<std::shared_ptr<Food>, double>> components;
+
+    // Memoized flattening: every leaf (non-composite) food reachable through
+    // the component tree with its total servings, plus the resulting nutrients.
+    // Rebuilt on first use after addComponent or invalidateCache.
+    mutable std::vector<std::pair<const Food*, double>> flattened;
+    mutable NutrientVector cachedNutrients;
+    mutable bool cacheValid = false;
+
+    // Rebuilds this cache and every stale one below it, children first and
+    // without recursion. rebuildCache and flattenInto only look one level
+    // down and expect the nested caches to be current.
+    void refreshCache() const;
+    void rebuildCache() const;
+    void flattenInto(std::vector<std::pair<const Food*, double>>& out, double scale) const;
     
 public:
+    static constexpr Kind KIND = Kind::COMPOSITE;
+
     CompositeFood(const std::string& id, const std::string& name, const std::vector<std::string>& keywords);
+
+    // Arena form, see Food. Components and the cache stay on the heap.
+    CompositeFood(std::string_view id, std::string_view name, const std::vector<std::string_view>& keywords,
+                  std::pmr::memory_resource* resource);
+
+    // Releases nested composites it solely owns iteratively, so dropping a
+    // deep hierarchy does not recurse once per level
+    ~CompositeFood() override;
     
-    // Add a component food with specified servings
+    // Add a component food with specified servings. Only this composite's
+    // cache is invalidated, so once it is in a FoodDatabase change it
+    // through FoodDatabase::addComponent, which also invalidates the
+    // composites containing it.
     void addComponent(const std::shared_ptr<Food>& food, double servings);
+
+    // Marks the memoized totals stale after a nested composite changed
+    void invalidateCache();
     
     // Override base class methods
     double getCalories() const override;
+    NutrientVector getNutrients() const override;
     void display() const override;
     
     // Accessor for components (needed for serialization)
     const std::vector<std::pair<std::shared_ptr<Food>, double>>& getComponents() const;
+
+    // Leaf foods and their accumulated servings per serving of this composite
+    const std::vector<std::pair<const Food*, double>>& getFlattenedComponents() const;
 };
 
 } // namespace diet
@@ -2,12 +2,41 @@
 
 namespace diet {
 
-Food::Food(const std::string& id, const std::string& name, const std::vector<std::string>& keywords)
-    : id(id), name(name), keywords(keywords) {}
+Food::Food(Kind kind, const std::string& id, const std::string& name, const std::vector<std::string>& keywords)
+    : kind(kind), id(id), name(name) {
+    this->keywords.reserve(keywords.size());
+    for (const auto& keyword : keywords) {
+        this->keywords.push_back(SymbolTable::global().intern(keyword));
+    }
+}
 
-std::string Food::getId() const { return id; }
-std::string Food::getName() const { return name; }
-std::vector<std::string> Food::getKeywords() const { return keywords; }
+Food::Food(Kind kind, std::string_view id, std::string_view name, const std::vector<std::string_view>& keywords,
+           std::pmr::memory_resource* resource)
+    : kind(kind), id(id, resource), name(name, resource), keywords(resource) {
+    this->keywords.reserve(keywords.size());
+    for (std::string_view keyword : keywords) {
+        this->keywords.push_back(SymbolTable::global().intern(keyword));
+    }
+}
+
+std::string_view Food::getId() const { return id; }
+std::string_view Food::getName() const { return name; }
+size_t Food::getKeywordCount() const { return keywords.size(); }
+
+std::string_view Food::getKeyword(size_t index) const {
+    return SymbolTable::global().getText(keywords[index]);
+}
+
+std::vector<std::string> Food::getKeywords() const {
+    std::vector<std::string> result;
+    result.reserve(keywords.size());
+    for (Symbol keyword : keywords) {
+        result.emplace_back(SymbolTable::global().getText(keyword));
+    }
+    return result;
+}
+
+const std::pmr::vector<Symbol>& Food::getKeywordSymbols() const { return keywords; }
 
 } // namespace diet
 
@@ -2,33 +2,72 @@
 #define FOOD_H
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include "NutrientVector.h"
+#include "SymbolTable.h"
 
 namespace diet {
 
 class Food {
+public:
+    // Concrete type, fixed at construction, so callers can dispatch on it
+    // (see foodAs below and visitFood in FoodVisit.h) instead of using RTTI
+    enum class Kind : uint8_t { BASIC, COMPOSITE };
+
 protected:
-    std::string id;
-    std::string name;
-    std::vector<std::string> keywords;
+    Kind kind;
+
+    // Allocated from the resource given at construction (the heap unless a
+    // FoodDatabase arena supplied one). Keywords are interned in
+    // SymbolTable::global().
+    std::pmr::string id;
+    std::pmr::string name;
+    std::pmr::vector<Symbol> keywords;
 
-public:
     // Constructor with member initialization list
-    Food(const std::string& id, const std::string& name, const std::vector<std::string>& keywords);
-    
+    Food(Kind kind, const std::string& id, const std::string& name, const std::vector<std::string>& keywords);
+
+    // Copies the text into resource, which must outlive the food
+    Food(Kind kind, std::string_view id, std::string_view name, const std::vector<std::string_view>& keywords,
+         std::pmr::memory_resource* resource);
+
+public:
     // Virtual destructor for proper polymorphic deletion
     virtual ~Food() = default;
     
-    // Getters with const correctness
-    std::string getId() const;
-    std::string getName() const;
+    Kind getKind() const { return kind; }
+
+    // Getters with const correctness. The views stay valid for the
+    // lifetime of the food.
+    std::string_view getId() const;
+    std::string_view getName() const;
+    size_t getKeywordCount() const;
+    std::string_view getKeyword(size_t index) const;
+    const std::pmr::vector<Symbol>& getKeywordSymbols() const;
+
+    // Copies every keyword; prefer getKeyword in loops
     std::vector<std::string> getKeywords() const;
     
     // Pure virtual methods for the interface
     virtual double getCalories() const = 0;
+    virtual NutrientVector getNutrients() const = 0;
     virtual void display() const = 0;
 };
 
+// food as a T (BasicFood or CompositeFood) if that is its kind, else null
+template <typename T>
+const T* foodAs(const Food* food) {
+    return food && food->getKind() == T::KIND ? static_cast<const T*>(food) : nullptr;
+}
+
+template <typename T>
+T* foodAs(Food* food) {
+    return food && food->getKind() == T::KIND ? static_cast<T*>(food) : nullptr;
+}
+
 } // namespace diet
 
 #endif // FOOD_H
@@ -0,0 +1,22 @@
+#ifndef FOOD_VISIT_H
+#define FOOD_VISIT_H
+
+#include "BasicFood.h"
+#include "CompositeFood.h"
+#include <utility>
+
+namespace diet {
+
+// Calls visitor with food as its concrete type, chosen by its kind tag.
+// Every overload the visitor provides must return the same type.
+template <typename Visitor>
+decltype(auto) visitFood(const Food& food, Visitor&& visitor) {
+    if (food.getKind() == Food::Kind::BASIC) {
+        return std::forward<Visitor>(visitor)(static_cast<const BasicFood&>(food));
+    }
+    return std::forward<Visitor>(visitor)(static_cast<const CompositeFood&>(food));
+}
+
+} // namespace diet
+
+#endif // FOOD_VISIT_H
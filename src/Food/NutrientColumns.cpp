@@ -0,0 +1,39 @@
+#include "NutrientColumns.h"
+
+namespace diet {
+
+void NutrientColumns::reserve(size_t rows) {
+    for (auto& values : columns) {
+        values.reserve(rows);
+    }
+}
+
+uint32_t NutrientColumns::append(const NutrientVector& nutrients) {
+    uint32_t index = static_cast<uint32_t>(size());
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        columns[n].push_back(nutrients[n]);
+    }
+    return index;
+}
+
+size_t NutrientColumns::size() const {
+    return columns[0].size();
+}
+
+NutrientVector NutrientColumns::row(uint32_t index) const {
+    NutrientVector nutrients;
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        nutrients[n] = columns[n][index];
+    }
+    return nutrients;
+}
+
+double NutrientColumns::get(uint32_t index, NutrientVector::Index nutrient) const {
+    return columns[nutrient][index];
+}
+
+const double* NutrientColumns::column(NutrientVector::Index nutrient) const {
+    return columns[nutrient].data();
+}
+
+} // namespace diet
@@ -0,0 +1,33 @@
+#ifndef NUTRIENT_COLUMNS_H
+#define NUTRIENT_COLUMNS_H
+
+#include "NutrientVector.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace diet {
+
+// Structure-of-arrays nutrient storage: one contiguous array per nutrient,
+// addressed by row. Rows are only ever appended, so a row number handed out
+// stays valid for the lifetime of the store.
+class NutrientColumns {
+private:
+    std::array<std::vector<double>, NutrientVector::COUNT> columns;
+
+public:
+    void reserve(size_t rows);
+    uint32_t append(const NutrientVector& nutrients);
+
+    size_t size() const;
+    NutrientVector row(uint32_t index) const;
+    double get(uint32_t index, NutrientVector::Index nutrient) const;
+
+    // Whole column for scans, size() values long
+    const double* column(NutrientVector::Index nutrient) const;
+};
+
+} // namespace diet
+
+#endif // NUTRIENT_COLUMNS_H
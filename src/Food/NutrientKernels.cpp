@@ -0,0 +1,87 @@
+#include "NutrientKernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DIET_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace diet {
+
+namespace {
+
+using Kernel = void (*)(const NutrientColumns&, const uint32_t*, const double*, size_t, NutrientVector&);
+
+#ifdef DIET_HAVE_AVX2_KERNEL
+// Four entries per step: each nutrient column is gathered at the four rows
+// and fused-multiply-added with the four servings
+__attribute__((target("avx2,fma")))
+void accumulateAvx2(const NutrientColumns& columns, const uint32_t* rows,
+                    const double* servings, size_t count, NutrientVector& out) {
+    const double* column[NutrientVector::COUNT];
+    __m256d sums[NutrientVector::COUNT];
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        column[n] = columns.column(static_cast<NutrientVector::Index>(n));
+        sums[n] = _mm256_setzero_pd();
+    }
+
+    // The masked gather with every lane enabled is the same load, but with
+    // a defined source operand (the unmasked form leaves it uninitialised)
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d allLanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + i));
+        __m256d scale = _mm256_loadu_pd(servings + i);
+        for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+            __m256d values = _mm256_mask_i32gather_pd(zero, column[n], index, allLanes, sizeof(double));
+            sums[n] = _mm256_fmadd_pd(values, scale, sums[n]);
+        }
+    }
+
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(sums[n]), _mm256_extractf128_pd(sums[n], 1));
+        out[n] += _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+    NutrientKernels::accumulateScalar(columns, rows + i, servings + i, count - i, out);
+}
+#endif
+
+// Chosen on first use, so it is safe to call from static initializers
+Kernel selectedKernel() {
+    static const Kernel kernel = [] {
+#ifdef DIET_HAVE_AVX2_KERNEL
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return static_cast<Kernel>(accumulateAvx2);
+        }
+#endif
+        return static_cast<Kernel>(NutrientKernels::accumulateScalar);
+    }();
+    return kernel;
+}
+
+} // namespace
+
+void NutrientKernels::accumulateScalar(const NutrientColumns& columns, const uint32_t* rows,
+                                       const double* servings, size_t count, NutrientVector& out) {
+    for (size_t n = 0; n < NutrientVector::COUNT; ++n) {
+        const double* column = columns.column(static_cast<NutrientVector::Index>(n));
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += column[rows[i]] * servings[i];
+        }
+        out[n] += sum;
+    }
+}
+
+void NutrientKernels::accumulate(const NutrientColumns& columns, const uint32_t* rows,
+                                 const double* servings, size_t count, NutrientVector& out) {
+    selectedKernel()(columns, rows, servings, count, out);
+}
+
+const char* NutrientKernels::activeKernel() {
+    return selectedKernel() == NutrientKernels::accumulateScalar ? "scalar" : "avx2";
+}
+
+} // namespace diet
@@ -0,0 +1,32 @@
+#ifndef NUTRIENT_KERNELS_H
+#define NUTRIENT_KERNELS_H
+
+#include "NutrientVector.h"
+#include "NutrientColumns.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace diet {
+
+// Batched servings x nutrients accumulation over a NutrientColumns store.
+// accumulate() picks an AVX2/FMA implementation at runtime when the CPU
+// supports it and falls back to the portable loop otherwise. Both add the
+// same products, but in a different order, so results may differ in the
+// last bits.
+class NutrientKernels {
+public:
+    // out += sum over i of columns.row(rows[i]) * servings[i]
+    static void accumulate(const NutrientColumns& columns, const uint32_t* rows,
+                           const double* servings, size_t count, NutrientVector& out);
+
+    // The portable implementation, always available
+    static void accumulateScalar(const NutrientColumns& columns, const uint32_t* rows,
+                                 const double* servings, size_t count, NutrientVector& out);
+
+    // Name of the implementation accumulate() dispatches to
+    static const char* activeKernel();
+};
+
+} // namespace diet
+
+#endif // NUTRIENT_KERNELS_H
@@ -0,0 +1,44 @@
+#ifndef NUTRIENT_VECTOR_H
+#define NUTRIENT_VECTOR_H
+
+#include <array>
+#include <cstddef>
+
+namespace diet {
+
+// Fixed-width bundle of the quantitative nutrients every food reports.
+// Kept as a plain array so accumulation loops compile to straight-line code.
+struct NutrientVector {
+    enum Index : size_t {
+        CALORIES = 0,
+        PROTEIN,
+        CARBS,
+        FAT,
+        SATURATED_FAT,
+        FIBER,
+        COUNT
+    };
+
+    std::array<double, COUNT> values{};
+
+    double& operator[](size_t i) { return values[i]; }
+    double operator[](size_t i) const { return values[i]; }
+
+    double calories() const { return values[CALORIES]; }
+    double protein() const { return values[PROTEIN]; }
+    double carbs() const { return values[CARBS]; }
+    double fat() const { return values[FAT]; }
+    double saturatedFat() const { return values[SATURATED_FAT]; }
+    double fiber() const { return values[FIBER]; }
+
+    // this += other * scale
+    void addScaled(const NutrientVector& other, double scale) {
+        for (size_t i = 0; i < COUNT; ++i) {
+            values[i] += other.values[i] * scale;
+        }
+    }
+};
+
+} // namespace diet
+
+#endif // NUTRIENT_VECTOR_H
@@ -0,0 +1,29 @@
+#include "SymbolTable.h"
+
+namespace diet {
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+Symbol SymbolTable::intern(std::string_view text) {
+    auto found = ids.find(text);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    Symbol symbol = static_cast<Symbol>(texts.size());
+    texts.emplace_back(text);
+    ids.emplace(texts.back(), symbol);
+    return symbol;
+}
+
+std::string_view SymbolTable::getText(Symbol symbol) const {
+    return texts[symbol];
+}
+
+size_t SymbolTable::size() const {
+    return texts.size();
+}
+
+} // namespace diet
@@ -0,0 +1,41 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+
+namespace diet {
+
+// Interned text, identified by a dense 32-bit ID
+using Symbol = uint32_t;
+
+// Maps repeated catalog strings (keywords, vitamin and mineral lists) to
+// symbols so each distinct value is stored once and compared as an integer.
+// Symbols are never released; the table only grows with the vocabulary.
+// Not thread-safe.
+class SymbolTable {
+private:
+    std::deque<std::string> texts;                     // indexed by symbol, stable addresses
+    std::unordered_map<std::string_view, Symbol> ids;  // views into texts
+
+public:
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // The table shared by all foods
+    static SymbolTable& global();
+
+    // Returns the existing symbol for text, adding it if needed
+    Symbol intern(std::string_view text);
+
+    std::string_view getText(Symbol symbol) const;
+    size_t size() const;
+};
+
+} // namespace diet
+
+#endif // SYMBOL_TABLE_H
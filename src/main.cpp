@@ -1,15 +1,55 @@
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include "CLI/CLIManager.h"
 
-int main() {
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--batch [script|-]]\n"
+              << "  --batch  run commands from a script (or stdin) without prompts,\n"
+              << "           printing one JSON result per command\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool batch = false;
+    std::string script = "-";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--batch") {
+            batch = true;
+            if (i + 1 < argc) {
+                script = argv[++i];
+            }
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
     try {
         diet::CLIManager cliManager;
-        cliManager.start();
+        if (!batch) {
+            cliManager.start();
+            return 0;
+        }
+
+        if (script == "-") {
+            return cliManager.runBatch(std::cin, std::cout) == 0 ? 0 : 1;
+        }
+        std::ifstream in(script);
+        if (!in) {
+            std::cerr << "Error: Cannot open batch script: " << script << std::endl;
+            return 2;
+        }
+        return cliManager.runBatch(in, std::cout) == 0 ? 0 : 1;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-    return 0;
 }